@@ -18,6 +18,7 @@
 #include <libCli/GrammarConstruction.hpp>
 #include <libCli/Call.hpp>
 #include <libCli/Completion.hpp>
+#include <libCli/Tracing.hpp>
 #include <versionDefine.h> // generated during build
 
 using namespace ArgParse;
@@ -45,24 +46,17 @@ const char* g_helpString =
 #include <gwhisper/HelpString.h>
 ;
 
-int main(int argc, char **argv)
+/// Acts according to the parsed arguments (completion, help, RPC call, ...).
+/// @returns exit code of gWhisper
+int handleParsedArguments(Grammar & grammarPool, ParsedElement & parseTree, ParseRc & rc, const std::string & args)
 {
-    // First we construct the initial Grammar for the CLI tool:
-    Grammar grammarPool;
-    GrammarElement * grammarRoot = cli::constructGrammar(grammarPool);
-
-    // Now we parse the given arguments using the grammar:
-    std::string args = getArgsAsString(argc, argv);
-    ParsedElement parseTree;
-    ParseRc rc = grammarRoot->parse(args.c_str(), parseTree);
-
     // TODO: add option to print parse tree after parsing:
     // // Now we act according to the parse tree:
     //std::cout << parseTree.getDebugString() << "\n";
 
     if(parseTree.findFirstChild("DotExport") != "")
     {
-        std::cout << grammarPool.getDotGraph();
+        std::cout << grammarPool.getDotGraph(parseTree.findFirstChild("ProfileParser") != "");
         return 0;
     }
 
@@ -71,11 +65,11 @@ int main(int argc, char **argv)
         bool completeDebug = (parseTree.findFirstChild("CompleteDebug") != "");
         if(parseTree.findFirstChild("fish") != "")
         {
-          cli::printFishCompletions(rc.candidates, parseTree, args, completeDebug);
+          cli::printFishCompletions(rc.candidates, parseTree, args, completeDebug, parseTree.getCandidateLimit());
         }
         else
         {
-          cli::printBashCompletions(rc.candidates, parseTree, args, completeDebug);
+          cli::printBashCompletions(rc.candidates, parseTree, args, completeDebug, parseTree.getCandidateLimit());
         }
         return 0;
     }
@@ -123,3 +117,61 @@ int main(int argc, char **argv)
 
     return -1;
 }
+
+int main(int argc, char **argv)
+{
+    // We do not know if tracing is requested before arguments are parsed, so
+    // phases are recorded until then:
+    cli::Tracer & tracer = cli::Tracer::getInstance();
+    tracer.setEnabled(true);
+
+    // First we construct the initial Grammar for the CLI tool:
+    Grammar grammarPool;
+    cli::TraceSpan constructGrammarSpan("constructGrammar", "grammar");
+    GrammarElement * grammarRoot = cli::constructGrammar(grammarPool);
+    grammarPool.freeze();
+    constructGrammarSpan.end();
+
+    // Now we parse the given arguments using the grammar:
+    std::string args = getArgsAsString(argc, argv);
+    ParsedElement parseTree;
+    // bounds the work done for completion candidates:
+    parseTree.setCandidateLimit(cli::getCompleteLimit(args));
+    cli::TraceSpan parseSpan("parseArguments", "grammar");
+    ParseRc rc = grammarRoot->parse(args.c_str(), parseTree);
+    parseSpan.end();
+
+    std::string traceFile = parseTree.findFirstChild("TraceFile");
+    bool printTiming = (parseTree.findFirstChild("Timing") != "");
+    if((traceFile == "") and (not printTiming))
+    {
+        tracer.setEnabled(false);
+    }
+
+    if(parseTree.findFirstChild("ProfileParser") != "")
+    {
+        // The first parse injected all grammar retrieved from the server, so
+        // profiling a second parse shows the cost of parsing only:
+        ArgParse::ParseProfiler::setEnabled(true);
+        ParsedElement profiledParseTree;
+        grammarRoot->parse(args.c_str(), profiledParseTree);
+        ArgParse::ParseProfiler::setEnabled(false);
+        if(parseTree.findFirstChild("DotExport") == "")
+        {
+            std::cerr << "Parser profile (top 30 grammar elements by self time):\n" << grammarPool.getProfileTable(30);
+        }
+    }
+
+    int result = handleParsedArguments(grammarPool, parseTree, rc, args);
+
+    if(printTiming)
+    {
+        std::cerr << tracer.getSummary();
+    }
+    if((traceFile != "") and (not tracer.writeChromeTrace(traceFile)))
+    {
+        std::cerr << "Error: Could not write trace file '" << traceFile << "'" << std::endl;
+        return -1;
+    }
+    return result;
+}
@@ -13,7 +13,11 @@
 // limitations under the License.
 
 #pragma once
+#include <algorithm>
+#include <typeinfo>
+#include <utility>
 #include <libArgParse/GrammarElement.hpp>
+#include <libArgParse/Concatenation.hpp>
 
 namespace ArgParse
 {
@@ -54,17 +58,25 @@ class Alternation : public GrammarElement
 
         virtual ParseRc parse(const char * f_string, ParsedElement & f_out_ParsedElement, size_t candidateDepth = 1, size_t startChild = 0) override
         {
+            ParseProfiler::Scope profilerScope(m_instanceId);
             ParseRc rc;
             f_out_ParsedElement.setGrammarElement(this);
 
             //std::cout << "Alternation " << std::to_string(m_instanceId) << ": parsing '" << f_string << " cd=" << candidateDepth << "'\n";
 
             std::vector<std::shared_ptr<ParsedElement> > candidateList;
+            // candidates beyond this are dropped (see ParsedElement::setCandidateLimit()):
+            const size_t maxCandidates = f_out_ParsedElement.getMaxCandidates();
 
             std::shared_ptr<ParsedElement> winner;
             std::shared_ptr<ParsedElement> maybeWinner;
             GrammarElement * maybeWinnerGE;
             GrammarElement * winnerGE;
+            // results of the children of concatenations, so parsing the
+            // winner again does not parse its children again:
+            Concatenation::ChildResults childResults;
+            Concatenation::ChildResults winnerResults;
+            Concatenation::ChildResults maybeWinnerResults;
             size_t maybeCount = 0;
             size_t newCandidateDepth = candidateDepth;
             if(candidateDepth > 0)
@@ -74,11 +86,27 @@ class Alternation : public GrammarElement
                 // again, this time allowing forks
                 newCandidateDepth--;
             }
-            std::vector<GrammarElement*> maybeList;
+            // children which matched (completely or partially) and the range
+            // of their candidates in candidateList:
+            struct Match
+            {
+                GrammarElement * child;
+                size_t lenParsed;
+                size_t firstCandidate;
+                size_t endCandidate;
+            };
+            std::vector<Match> maybeList;
             for(auto child : m_children)
             {
                 auto newParsedElement = std::make_shared<ParsedElement>(&f_out_ParsedElement);
-                ParseRc childRc = child->parse(f_string, *newParsedElement, newCandidateDepth);
+                Concatenation * concatenation = asConcatenation(child);
+                if(concatenation != nullptr)
+                {
+                    childResults.clear();
+                }
+                ParseRc childRc = (concatenation != nullptr) ?
+                    concatenation->parseWithChildResults(f_string, *newParsedElement, newCandidateDepth, childResults) :
+                    child->parse(f_string, *newParsedElement, newCandidateDepth);
                 //std::cout << " Alternation pass1 "<< std::to_string(m_instanceId) <<  " parsed child ? rc=" << childRc.toString() << " #candidates: " << std::to_string(childRc.candidates.size()) << std::endl;
                 if(childRc.isGood())
                 {
@@ -90,15 +118,23 @@ class Alternation : public GrammarElement
                         rc.lenParsed = childRc.lenParsed;
                         winner = newParsedElement;
                         winnerGE = child;
+                        if(concatenation != nullptr)
+                        {
+                            std::swap(winnerResults, childResults);
+                        }
                     }
-                    maybeList.push_back(child);
+                    maybeList.push_back({child, childRc.lenParsed, candidateList.size(), candidateList.size() + childRc.candidates.size()});
                 }
                 if(childRc.isBad() && (childRc.errorType == ParseRc::ErrorType::missingText))
                 {
                     maybeWinner = newParsedElement;
                     maybeWinnerGE = child;
+                    if(concatenation != nullptr)
+                    {
+                        std::swap(maybeWinnerResults, childResults);
+                    }
                     maybeCount++;
-                    maybeList.push_back(child);
+                    maybeList.push_back({child, childRc.lenParsed, candidateList.size(), candidateList.size() + childRc.candidates.size()});
                 }
                 else if(childRc.isBad() && (childRc.errorType == ParseRc::ErrorType::retrievingGrammarFailed))
                 {
@@ -120,33 +156,25 @@ class Alternation : public GrammarElement
                 f_out_ParsedElement.addChild(winner);
 
                 // parse again allowing forks this time. to get possible candidates in optional paths
-                ParsedElement unused;
-                ParseRc childRc = winnerGE->parse(f_string, unused, candidateDepth);
-                candidateList = childRc.candidates;
-
-                // unfortunately we now lost the previous candidates.
-                // need to parse again all children except winner to get those again.
-                // TODO: this is ugly. fix it better
-                for(auto child : maybeList)
+                ParseRc childRc = parseAgain(f_string, winnerGE, *winner, candidateDepth, winnerResults);
+
+                // the winner's candidates come first, followed by those of
+                // all other children from the first parse:
+                for(const Match & match : maybeList)
                 {
-                    if(child == winnerGE)
+                    if(match.child == winnerGE)
                     {
                         continue;
                     }
-                    auto newParsedElement = std::make_shared<ParsedElement>(&f_out_ParsedElement);
-                    ParseRc childRc = child->parse(f_string, *newParsedElement, newCandidateDepth);
-                    if(childRc.lenParsed < rc.lenParsed)
+                    if(match.lenParsed < rc.lenParsed)
                     {
                         // we skip this succestion if the length is less tah our winner
                         // (only keep additional options if they branch after the winner)
                         continue;
                     }
-                    for(auto candidate : childRc.candidates)
-                    {
-                        //std::cout << "  Alternation"<< std::to_string(m_instanceId) << ": have possible candidate: '" << candidate->getMatchedString() << "'" << std::endl;
-                        candidateList.push_back(candidate);
-                    }
+                    childRc.candidates.insert(childRc.candidates.end(), candidateList.begin() + match.firstCandidate, candidateList.begin() + match.endCandidate);
                 }
+                candidateList.swap(childRc.candidates);
             }
             else
             {
@@ -157,9 +185,7 @@ class Alternation : public GrammarElement
                     f_out_ParsedElement.addChild(maybeWinner);
                     // in this case we could uniquely identify a candidate :)
                     // so we need to parse again for candidates, this time allowing for forks
-                    candidateList.clear();
-                    ParsedElement unused;
-                    ParseRc childRc = maybeWinnerGE->parse(f_string, unused, candidateDepth);
+                    ParseRc childRc = parseAgain(f_string, maybeWinnerGE, *maybeWinner, candidateDepth, maybeWinnerResults);
                     candidateList = childRc.candidates;
                     //std::cout << " Alternation pass2 "<< std::to_string(m_instanceId) <<  " parsed child ? rc=" << childRc.toString() << " #candidates: " << std::to_string(childRc.candidates.size()) << std::endl;
                 }
@@ -184,6 +210,10 @@ class Alternation : public GrammarElement
             }
 
             // add all candidates to the candidate list
+            if(candidateList.size() > maxCandidates)
+            {
+                selectCandidates(candidateList, maxCandidates);
+            }
             for(auto candidate : candidateList)
             {
                 //std::cout << "Alt " << std::to_string(m_instanceId) << " handling candidate '" << candidate->getMatchedString() << "'" << std::endl; 
@@ -195,6 +225,73 @@ class Alternation : public GrammarElement
 
             return rc;
         }
+
+    private:
+        /// Parses f_child (already parsed into f_parsedElement with a lower
+        /// candidateDepth) again with f_candidateDepth and returns the result.
+        /// The parse tree is not changed. Concatenations re-use the results of
+        /// their children from the first parse, so the work for nested
+        /// alternations does not double with every level.
+        ParseRc parseAgain(const char * f_string, GrammarElement * f_child, ParsedElement & f_parsedElement, size_t f_candidateDepth, Concatenation::ChildResults & f_childResults)
+        {
+            ParsedElement unused;
+            unused.setCandidateLimit(f_parsedElement.getCandidateLimit());
+            Concatenation * concatenation = asConcatenation(f_child);
+            if(concatenation == nullptr)
+            {
+                return f_child->parse(f_string, unused, f_candidateDepth);
+            }
+            ParseRc rc = concatenation->parseWithChildResults(f_string, unused, f_candidateDepth, f_childResults);
+            // the re-used children were added to unused as well:
+            for(auto & child : f_parsedElement.getChildren())
+            {
+                child->setParent(&f_parsedElement);
+            }
+            return rc;
+        }
+
+        /// @returns f_child if it is a Concatenation, nullptr otherwise
+        static Concatenation * asConcatenation(GrammarElement * f_child)
+        {
+            // cheaper than a dynamic_cast, nothing derives from Concatenation:
+            if(typeid(*f_child) == typeid(Concatenation))
+            {
+                return static_cast<Concatenation*>(f_child);
+            }
+            return nullptr;
+        }
+
+        /// Keeps only f_maxCandidates of f_candidates. Candidates with
+        /// documentation are preferred, as the completion ranks them first.
+        /// The order of the kept candidates is not changed.
+        static void selectCandidates(std::vector<std::shared_ptr<ParsedElement> > & f_candidates, size_t f_maxCandidates)
+        {
+            std::vector<bool> documented(f_candidates.size());
+            size_t numDocumented = 0;
+            for(size_t i = 0; i < f_candidates.size(); i++)
+            {
+                documented[i] = f_candidates[i]->hasShortDocument();
+                if(documented[i])
+                {
+                    numDocumented++;
+                }
+            }
+            size_t keepDocumented = std::min(numDocumented, f_maxCandidates);
+            size_t keepUndocumented = f_maxCandidates - keepDocumented;
+
+            std::vector<std::shared_ptr<ParsedElement> > selected;
+            selected.reserve(f_maxCandidates);
+            for(size_t i = 0; i < f_candidates.size(); i++)
+            {
+                size_t & keep = documented[i] ? keepDocumented : keepUndocumented;
+                if(keep > 0)
+                {
+                    keep--;
+                    selected.push_back(f_candidates[i]);
+                }
+            }
+            f_candidates.swap(selected);
+        }
 };
 
 }
@@ -13,6 +13,8 @@
 // limitations under the License.
 
 #include <libArgParse/ArgParse.hpp>
+#include <algorithm>
+#include <map>
 
 //uint32_t ArgParse::GrammarElement::m_instanceCounter = 0;
 
@@ -52,9 +54,9 @@ std::string ArgParse::ParsedElement::findFirstChild(const std::string & f_elemen
 std::string ArgParse::ParsedElement::getShortDocument() const
 {
     std::string rightmostDoc = "";
-    for(auto iChild = m_children.rbegin(); iChild != m_children.rend(); iChild++)
+    for(size_t i = m_children.size(); i > 0; i--)
     {
-        std::string doc = (*iChild)->getShortDocument();
+        std::string doc = m_children[i-1]->getShortDocument();
         if( doc != "")
         {
             return doc;
@@ -64,6 +66,19 @@ std::string ArgParse::ParsedElement::getShortDocument() const
     return m_grammarElement->getDocument();
 }
 
+bool ArgParse::ParsedElement::hasShortDocument() const
+{
+    for(const auto & child : m_children)
+    {
+        if(child->hasShortDocument())
+        {
+            return true;
+        }
+    }
+
+    return not m_grammarElement->getDocument().empty();
+}
+
 void ArgParse::ParsedElement::findAllSubTrees(const std::string & f_elementName, std::vector<ArgParse::ParsedElement *> & f_out_result, bool f_doNotSearchChildsOfMatchingElements, uint32_t f_depth)
 {
     if(m_grammarElement->getElementName() == f_elementName)
@@ -118,20 +133,105 @@ ArgParse::ParsedElement & ArgParse::ParsedElement::findFirstSubTree(const std::s
     return *this;
 }
 
-std::string ArgParse::Grammar::getDotGraph()
+static double toMilliseconds(std::chrono::steady_clock::duration f_duration)
+{
+    return std::chrono::duration<double, std::milli>(f_duration).count();
+}
+
+std::string ArgParse::Grammar::getDotGraph(bool f_withProfile)
 {
     //std::cout << "GENERATING DOT GRAPH\n";
+    std::map<uint32_t, ParseProfiler::ElementStatistics> statistics;
+    std::chrono::steady_clock::duration maxSelfTime = std::chrono::steady_clock::duration::zero();
+    if(f_withProfile)
+    {
+        statistics = ParseProfiler::getStatistics();
+        for(auto & elementStatistics : statistics)
+        {
+            maxSelfTime = std::max(maxSelfTime, elementStatistics.second.selfTime);
+        }
+    }
+
     std::string result = "digraph {\n";
     result += "ordering=out;\n";
+    char buffer[256];
+    std::lock_guard<std::mutex> lock(m_mutex);
     for(auto & node : m_nodes)
     {
         //printf("getting info for node %p\n", node.get());
         result += node->getDotNode();
+
+        auto elementStatistics = statistics.find(node->getInstanceId());
+        if(elementStatistics != statistics.end())
+        {
+            // heat: saturation of red proportional to self time
+            const ParseProfiler::ElementStatistics & stats = elementStatistics->second;
+            double heat = (maxSelfTime.count() > 0) ? static_cast<double>(stats.selfTime.count()) / maxSelfTime.count() : 0.0;
+            snprintf(buffer, sizeof(buffer), "n%u[style=filled, fillcolor=\"0.000 %.3f 1.000\", xlabel=\"calls: %llu\\nself: %.3f ms\\ntotal: %.3f ms\\nparsed: %llu\"];\n",
+                    node->getInstanceId(),
+                    heat,
+                    static_cast<unsigned long long>(stats.calls),
+                    toMilliseconds(stats.selfTime),
+                    toMilliseconds(stats.totalTime),
+                    static_cast<unsigned long long>(stats.parsedElements));
+            result += buffer;
+        }
     }
     result += "}\n";
     return result;
 }
 
+void ArgParse::Grammar::freeze()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for(auto & node : m_nodes)
+    {
+        node->freeze();
+    }
+}
+
+std::string ArgParse::Grammar::getProfileTable(size_t f_maxRows)
+{
+    std::map<uint32_t, ParseProfiler::ElementStatistics> statistics = ParseProfiler::getStatistics();
+
+    std::vector<std::pair<GrammarElement*, ParseProfiler::ElementStatistics> > rows;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for(auto & node : m_nodes)
+    {
+        auto elementStatistics = statistics.find(node->getInstanceId());
+        if(elementStatistics != statistics.end())
+        {
+            rows.push_back(std::make_pair(node.get(), elementStatistics->second));
+        }
+    }
+    std::sort(rows.begin(), rows.end(), [](const std::pair<GrammarElement*, ParseProfiler::ElementStatistics> & f_lhs, const std::pair<GrammarElement*, ParseProfiler::ElementStatistics> & f_rhs)
+            {
+                return f_lhs.second.selfTime > f_rhs.second.selfTime;
+            });
+    if((f_maxRows > 0) and (rows.size() > f_maxRows))
+    {
+        rows.resize(f_maxRows);
+    }
+
+    std::string result;
+    char buffer[256];
+    snprintf(buffer, sizeof(buffer), "%8s %-24s %-24s %10s %12s %12s %10s\n", "id", "type", "name", "calls", "self ms", "total ms", "parsed");
+    result += buffer;
+    for(auto & row : rows)
+    {
+        snprintf(buffer, sizeof(buffer), "%8u %-24s %-24s %10llu %12.3f %12.3f %10llu\n",
+                row.first->getInstanceId(),
+                row.first->getTypeName().c_str(),
+                row.first->getElementName().c_str(),
+                static_cast<unsigned long long>(row.second.calls),
+                toMilliseconds(row.second.selfTime),
+                toMilliseconds(row.second.totalTime),
+                static_cast<unsigned long long>(row.second.parsedElements));
+        result += buffer;
+    }
+    return result;
+}
+
 // not used, only for formatting the options().DebugString() of protobuf reflection
 std::string ArgParse::ParsedDocument::getOptionString(std::string f_optString)
 {
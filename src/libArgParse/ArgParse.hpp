@@ -57,4 +57,6 @@
 #include <libArgParse/GrammarInjector.hpp>
 #include <libArgParse/GrammarFactory.hpp>
 #include <libArgParse/EscapedString.hpp>
+#include <libArgParse/ParseProfiler.hpp>
+#include <libArgParse/IncrementalParser.hpp>
 
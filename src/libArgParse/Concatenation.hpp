@@ -51,12 +51,70 @@ class Concatenation : public GrammarElement
             return result;
         }
 
+        /// Results of the children parsed by parseWithChildResults()
+        struct ChildResults
+        {
+            std::vector<std::shared_ptr<ParsedElement> > parsedElements;
+            std::vector<ParseRc> rcs;
+            /// Last leaves of the children's candidates, which were not stopped
+            /// when the children were parsed (see ParsedElement::setStops())
+            std::vector<ParsedElement *> unstoppedLeaves;
+
+            void add(const std::shared_ptr<ParsedElement> & f_parsedElement, const ParseRc & f_rc)
+            {
+                parsedElements.push_back(f_parsedElement);
+                rcs.push_back(f_rc);
+                for(auto & candidate : f_rc.candidates)
+                {
+                    ParsedElement & leaf = candidate->getLastLeaf();
+                    if(not leaf.stops())
+                    {
+                        unstoppedLeaves.push_back(&leaf);
+                    }
+                }
+            }
+
+            void clear()
+            {
+                parsedElements.clear();
+                rcs.clear();
+                unstoppedLeaves.clear();
+            }
+        };
+
         virtual ParseRc parse(const char * f_string, ParsedElement & f_out_ParsedElement, size_t candidateDepth = 1, size_t startChild = 0) override
         {
+            return parseChildren(f_string, f_out_ParsedElement, candidateDepth, startChild, nullptr);
+        }
+
+        /// Parses like parse() and keeps the results of the parsed children in
+        /// f_childResults. If f_childResults already holds the results of a
+        /// previous call with the same f_string, those are used instead of
+        /// parsing the children again.
+        /// The children are always parsed with candidateDepth 1, so this allows
+        /// to parse again with another candidateDepth without repeating the
+        /// work of the children (see Alternation).
+        ParseRc parseWithChildResults(const char * f_string, ParsedElement & f_out_ParsedElement, size_t candidateDepth, ChildResults & f_childResults)
+        {
+            // the previous parse might have stopped the candidates while forking:
+            for(ParsedElement * leaf : f_childResults.unstoppedLeaves)
+            {
+                leaf->clearStops();
+            }
+            return parseChildren(f_string, f_out_ParsedElement, candidateDepth, 0, &f_childResults);
+        }
+
+    private:
+        ParseRc parseChildren(const char * f_string, ParsedElement & f_out_ParsedElement, size_t candidateDepth, size_t startChild, ChildResults * f_childResults)
+        {
+            ParseProfiler::Scope profilerScope(m_instanceId);
             //std::cout << "Concat " << std::to_string(m_instanceId) << " parsing '" << std::string(f_string) << "' cd=" << std::to_string(candidateDepth) << std::endl; 
             ParseRc rc;
             ParseRc childRc;
             f_out_ParsedElement.setGrammarElement(this);
+            // children re-used from a previous parse:
+            rc.lenParsed = f_out_ParsedElement.getReusedLength();
+            rc.lenParsedSuccessfully = rc.lenParsed;
 
             if(m_children.size() == 0)
             {
@@ -71,8 +129,27 @@ class Concatenation : public GrammarElement
                 //printf(" parsing child %zu\n", i);
                 GrammarElement* child = m_children[i];
 
-                auto newParsedElement = std::make_shared<ParsedElement>(&f_out_ParsedElement);
-                childRc = child->parse(&f_string[rc.lenParsed], *newParsedElement);
+                std::shared_ptr<ParsedElement> newParsedElement;
+                if((f_childResults != nullptr) and (i < f_childResults->rcs.size()))
+                {
+                    // child was already parsed by parseWithChildResults():
+                    newParsedElement = f_childResults->parsedElements[i];
+                    childRc = f_childResults->rcs[i];
+                }
+                else
+                {
+                    // the first child might continue the unfinished result of a previous parse:
+                    newParsedElement = f_out_ParsedElement.takeContinuedChild();
+                    if(newParsedElement == nullptr)
+                    {
+                        newParsedElement = std::make_shared<ParsedElement>(&f_out_ParsedElement);
+                    }
+                    childRc = child->parse(&f_string[rc.lenParsed], *newParsedElement, 1, newParsedElement->getChildren().size());
+                    if(f_childResults != nullptr)
+                    {
+                        f_childResults->add(newParsedElement, childRc);
+                    }
+                }
                 //std::cout << " Concat "<< std::to_string(m_instanceId) <<  " parsed child" << std::to_string(i) << " rc=" << childRc.toString() << " #candidates: " << std::to_string(childRc.candidates.size()) << " cd=" << candidateDepth<< std::endl;
                 rc.lenParsed += childRc.lenParsed;
                 rc.lenParsedSuccessfully += childRc.lenParsedSuccessfully;
@@ -86,18 +163,22 @@ class Concatenation : public GrammarElement
 
                 if(childRc.candidates.size() > 0)
                 {
+                    // candidates beyond this are dropped (see ParsedElement::setCandidateLimit()):
+                    const size_t maxCandidates = f_out_ParsedElement.getMaxCandidates();
                     for(auto candidate : childRc.candidates)
                     {
+                        if(rc.candidates.size() >= maxCandidates)
+                        {
+                            break;
+                        }
                         //std::cout << "Concat " << std::to_string(m_instanceId) << GrammarElement::toString() << " handling candidate from child " << std::to_string(i)<< " '" << candidate->getMatchedString() << "' cd=" << std::to_string(candidateDepth) << std::endl; 
                         // we create a new candidate (same tree level as f_out_ParsedElement)
                         auto candidateRoot = std::make_shared<ParsedElement>(f_out_ParsedElement.getParent());
                         candidateRoot->setGrammarElement(this);
 
-                        // first add all previous childs to the new root (from concatenation before the failing element):
-                        for(auto oldChild : f_out_ParsedElement.getChildren())
-                        {
-                            candidateRoot->getChildren().push_back(oldChild);
-                        }
+                        // first add all previous childs to the new root (from concatenation before the failing element).
+                        // They are shared with f_out_ParsedElement, not copied:
+                        candidateRoot->shareChildren(f_out_ParsedElement);
 
                         // add the candidate to the new root:
                         candidateRoot->addChild(candidate);
@@ -173,6 +254,16 @@ class Concatenation : public GrammarElement
                 }
             }
 
+            if(rc.candidates.size() > 0)
+            {
+                // forks may have added more candidates at once:
+                const size_t maxCandidates = f_out_ParsedElement.getMaxCandidates();
+                if(rc.candidates.size() > maxCandidates)
+                {
+                    rc.candidates.resize(maxCandidates);
+                }
+            }
+
             //std::cout << "Concat "<< std::to_string(m_instanceId) <<  " returning rc=" << rc.toString() << " with " << std::to_string(rc.candidates.size()) << " candidates" << std::endl;
 
             return rc;
@@ -46,6 +46,7 @@ class EscapedString : public GrammarElement
 
         virtual ParseRc parse(const char * f_string, ParsedElement & f_out_ParsedElement, size_t candidateDepth = 1, size_t startChild = 0) override
         {
+            ParseProfiler::Scope profilerScope(m_instanceId);
             ParseRc rc;
             ParseRc childRc;
             f_out_ParsedElement.setGrammarElement(this);
@@ -14,9 +14,13 @@
 
 #include <libArgParse/GrammarElement.hpp>
 #include <memory>
+#include <mutex>
 namespace ArgParse
 {
 
+    /// Owns all elements of a grammar.
+    /// Elements may be created concurrently (e.g. by GrammarInjectors parsed
+    /// from multiple threads).
     class Grammar
     {
         public:
@@ -29,8 +33,9 @@ namespace ArgParse
                 {
                     T * newNodePtr = new T(std::forward<Args>(f_args)...);
                     std::unique_ptr<T> newNode(newNodePtr);
+                    std::lock_guard<std::mutex> lock(m_mutex);
                     m_nodes.push_back(std::move(newNode));
-                    return static_cast<T*>(m_nodes.back().get());
+                    return newNodePtr;
                 }
 
             void setRoot( GrammarElement * f_rootElement)
@@ -38,13 +43,30 @@ namespace ArgParse
                 m_rootElement = f_rootElement;
             }
 
-            std::string getDotGraph();
+            /// Freezes all elements created so far (see GrammarElement::freeze()).
+            /// Call this after constructing the grammar and before parsing
+            /// it from multiple threads. Elements created afterwards by
+            /// GrammarInjectors are frozen on injection.
+            /// Must not be called while the grammar is parsed: this visits all
+            /// elements, also those an injection is still constructing.
+            void freeze();
+
+            /// @param f_withProfile if true, nodes are annotated with ParseProfiler
+            ///     statistics and colored by their self time (red = hot)
+            /// Must not be called while the grammar is parsed, see freeze().
+            std::string getDotGraph(bool f_withProfile = false);
+
+            /// @returns a table of ParseProfiler statistics of all elements of
+            ///     this grammar, sorted by self time (descending)
+            /// @param f_maxRows maximum number of elements listed (0 = all)
+            std::string getProfileTable(size_t f_maxRows = 0);
 
             virtual ~Grammar()
             {
             }
 
         private:
+            std::mutex m_mutex;
             std::vector< std::unique_ptr<GrammarElement> > m_nodes;
             GrammarElement * m_rootElement;
     };
@@ -14,10 +14,13 @@
 
 #pragma once
 #include <libArgParse/ArgParse.hpp>
+#include <atomic>
+#include <cassert>
 #include <vector>
 #include <string>
 #include <memory>
 #include <libArgParse/ArgParseUtils.hpp>
+#include <libArgParse/ParseProfiler.hpp>
 
 namespace ArgParse
 {
@@ -32,7 +35,8 @@ class GrammarElement
             m_typeName(f_typeName),
             m_elementName(f_elementName),
             m_document(""),
-            m_instanceId(getAndIncrementInstanceCounter())
+            m_instanceId(getAndIncrementInstanceCounter()),
+            m_frozen(false)
         {
         }
 
@@ -64,6 +68,12 @@ class GrammarElement
          *  Currently only a candidateDepth of 1 is tested.
          * @param startChild The child number to start parsing from. Can be
          *  used to start parsing from a specific grammar element.
+         *  f_out_ParsedElement already contains the results of the children
+         *  before. They matched the first
+         *  f_out_ParsedElement.getReusedLength() characters of f_string, if
+         *  this is 0, f_string starts behind them. Concatenation,
+         *  Repetition, Optional and GrammarInjector also continue an
+         *  unfinished child (see ParsedElement::setContinuedChild()).
          *  Currently this is mostly used internally.
          *  TODO: Think about making this protected
          * @returns ParseRc with the following attributes:
@@ -89,7 +99,12 @@ class GrammarElement
         // this would make grammar construction easier
         GrammarElement * addChild(GrammarElement * f_child)
         {
-            f_child->setParent(this);
+            assert(not m_frozen && "children added to a frozen grammar element");
+            // frozen elements may be shared with other threads, they keep their parent
+            if(not f_child->m_frozen)
+            {
+                f_child->setParent(this);
+            }
             m_children.push_back(f_child); 
             return this;
         }
@@ -99,6 +114,36 @@ class GrammarElement
             m_parent = f_parent;
         }
 
+        /// Marks this element and all elements reachable from it as immutable.
+        /// A frozen (sub-)grammar may be parsed from multiple threads
+        /// concurrently, as long as it is published to them after freezing
+        /// (e.g. by starting the threads afterwards).
+        /// Frozen elements cannot be modified anymore. Already frozen children
+        /// are not traversed again, so cyclic grammars are supported.
+        /// Grammars injected later by GrammarInjectors are frozen on injection.
+        void freeze()
+        {
+            if(m_frozen)
+            {
+                return;
+            }
+            m_frozen = true;
+            for(auto child : m_children)
+            {
+                child->freeze();
+            }
+        }
+
+        bool isFrozen() const
+        {
+            return m_frozen;
+        }
+
+        const std::vector< GrammarElement * > & getChildren() const
+        {
+            return m_children;
+        }
+
         // TODO: what is the difference between tag and ElementName??
         //  tag does not seem to be used
         std::string getTag() const
@@ -116,13 +161,19 @@ class GrammarElement
             return m_elementName;
         }
 
-        std::string getDocument() const
+        uint32_t getInstanceId() const
+        {
+            return m_instanceId;
+        }
+
+        const std::string & getDocument() const
         {
             return m_document;
         }
 
         void setDocument(const std::string & f_document)
         {
+            assert(not m_frozen && "document set on a frozen grammar element");
             m_document = f_document;
         }
 
@@ -151,11 +202,12 @@ class GrammarElement
         const std::string m_elementName;
         const uint32_t m_instanceId;
         std::string m_document;
+        bool m_frozen;
     private:
         static uint32_t getAndIncrementInstanceCounter()
         {
-            static uint32_t instanceCounter = 0;
-            return instanceCounter++;
+            static std::atomic<uint32_t> instanceCounter(0);
+            return instanceCounter.fetch_add(1, std::memory_order_relaxed);
         }
 };
 
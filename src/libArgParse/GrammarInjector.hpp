@@ -15,31 +15,40 @@
 #pragma once
 #include <libArgParse/GrammarElement.hpp>
 #include <libArgParse/Grammar.hpp>
+#include <atomic>
+#include <mutex>
 
 namespace ArgParse
 {
 
+/// Injects a grammar, which is retrieved on first parse (e.g. from a server).
+/// Injection happens once per injector, also if it is parsed from multiple
+/// threads concurrently: the first thread retrieves the grammar, others wait
+/// for it. If retrieving fails, the next parse tries again.
+/// The injected grammar is frozen before it is used.
+/// A child added before the first parse (e.g. a stub) is used as injected
+/// grammar, getGrammar() is not called then.
+/// A retrieved grammar is not added to the children, so a frozen injector
+/// stays unchanged. Functions traversing the grammar use getInjectedGrammar().
 class GrammarInjector : public GrammarElement
 {
     public:
         explicit GrammarInjector(const std::string & f_typeName, const std::string & f_elementName = "") :
-            GrammarElement("GrammarInjector::" + f_typeName, f_elementName)
+            GrammarElement("GrammarInjector::" + f_typeName, f_elementName),
+            m_injectedGrammar(nullptr)
         {
         }
         virtual ParseRc parse(const char * f_string, ParsedElement & f_out_ParsedElement, size_t candidateDepth = 1, size_t startChild = 0) override final
         {
-            if(m_children.size() == 0)
+            ParseProfiler::Scope profilerScope(m_instanceId);
+            GrammarElement * injectedGrammar = m_injectedGrammar.load(std::memory_order_acquire);
+            if(injectedGrammar == nullptr)
             {
                 ParseRc rc;
                 // we first need to inject new grammar:
-                GrammarElement * newGrammar = getGrammar(f_out_ParsedElement.getRoot(), rc.ErrorMessage);
+                injectedGrammar = injectGrammar(f_out_ParsedElement.getRoot(), rc.ErrorMessage);
 
-                if(newGrammar != nullptr)
-                {
-                    // retrieving grammar succeeded :-)
-                    addChild(newGrammar);
-                }
-                else
+                if(injectedGrammar == nullptr)
                 {
                     // retrieving grammar failed :-(
                     // -> we need to cause parse to fail due to missing grammar.
@@ -56,10 +65,14 @@ class GrammarInjector : public GrammarElement
             }
 
             f_out_ParsedElement.setGrammarElement(this);
-            auto child = std::make_shared<ParsedElement>(&f_out_ParsedElement);
+            // the child might continue the unfinished result of a previous parse:
+            std::shared_ptr<ParsedElement> child = f_out_ParsedElement.takeContinuedChild();
+            if(child == nullptr)
+            {
+                child = std::make_shared<ParsedElement>(&f_out_ParsedElement);
+            }
             // we transparently skip to parsing the new child
-            //return m_children[0]->parse(f_string, f_out_ParsedElement, candidateDepth);
-            ParseRc childRc = m_children[0]->parse(f_string, *child, candidateDepth);
+            ParseRc childRc = injectedGrammar->parse(f_string, *child, candidateDepth, child->getChildren().size());
 
             f_out_ParsedElement.addChild(child);
 
@@ -67,5 +80,56 @@ class GrammarInjector : public GrammarElement
         }
 
         virtual GrammarElement * getGrammar(ParsedElement * f_parseTree, std::string & f_ErrorMessage) = 0;
+
+        /// @returns the injected grammar, nullptr if nothing was injected yet.
+        ///     The injected grammar is frozen.
+        GrammarElement * getInjectedGrammar() const
+        {
+            return m_injectedGrammar.load(std::memory_order_acquire);
+        }
+
+        virtual std::string getDotNode() override
+        {
+            std::string result = GrammarElement::getDotNode();
+            GrammarElement * injectedGrammar = getInjectedGrammar();
+            if((injectedGrammar != nullptr) and m_children.empty())
+            {
+                result += " n" + std::to_string(m_instanceId) + " -> n" + std::to_string(injectedGrammar->getInstanceId()) + ";\n";
+            }
+            return result;
+        }
+
+    private:
+        GrammarElement * injectGrammar(ParsedElement * f_parseTree, std::string & f_ErrorMessage)
+        {
+            std::lock_guard<std::mutex> lock(m_injectionMutex);
+            GrammarElement * injectedGrammar = m_injectedGrammar.load(std::memory_order_relaxed);
+            if(injectedGrammar != nullptr)
+            {
+                // injected by another thread while we were waiting
+                return injectedGrammar;
+            }
+
+            if(m_children.empty())
+            {
+                injectedGrammar = getGrammar(f_parseTree, f_ErrorMessage);
+                if(injectedGrammar == nullptr)
+                {
+                    return nullptr;
+                }
+                // retrieving grammar succeeded :-)
+            }
+            else
+            {
+                // a child added before the first parse is used without calling getGrammar()
+                injectedGrammar = m_children[0];
+            }
+            injectedGrammar->freeze();
+            m_injectedGrammar.store(injectedGrammar, std::memory_order_release);
+            return injectedGrammar;
+        }
+
+        std::mutex m_injectionMutex;
+        std::atomic<GrammarElement *> m_injectedGrammar;
 };
 }
@@ -0,0 +1,182 @@
+// Copyright 2019 IBM Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#pragma once
+#include <libArgParse/Concatenation.hpp>
+#include <libArgParse/GrammarInjector.hpp>
+#include <libArgParse/Optional.hpp>
+#include <libArgParse/Repetition.hpp>
+#include <libArgParse/ParsedElement.hpp>
+#include <libArgParse/ArgParseUtils.hpp>
+
+#include <cctype>
+#include <memory>
+#include <string>
+
+namespace ArgParse
+{
+
+/// Parses a sequence of inputs with the same grammar, e.g. the argument line
+/// while the user types, re-using the result of the previous parse.
+///
+/// The children of the previous parse tree which end before the last
+/// whitespace both inputs have in common are shared (not copied) with the new
+/// parse tree. The child behind them is continued (see
+/// ParsedElement::setContinuedChild()), re-using its children in the same way,
+/// as long as it is a Concatenation, Repetition, Optional or GrammarInjector.
+/// Parsing then continues behind the re-used children (see the startChild
+/// parameter of GrammarElement::parse()), so the cost does not depend on the
+/// length of the unchanged prefix. E.g. for the gWhisper grammar only the last
+/// method argument is parsed again, not all of them. Elements still see the
+/// complete input, so they get the same result as when parsing from scratch,
+/// also if they discard a continued child.
+/// The shared children are re-parented into the new parse tree, so previous
+/// parse trees may be destroyed. Navigating from a shared child of a previous
+/// parse tree to its parent leads to the newest parse tree.
+///
+/// This is exact for grammars in which the result of an element does not
+/// depend on input after the next whitespace behind its match. This holds
+/// for whitespace separated arguments (e.g. the gWhisper grammar).
+/// Any other root element is always parsed completely.
+class IncrementalParser
+{
+    public:
+        explicit IncrementalParser(GrammarElement * f_grammarRoot) :
+            m_grammarRoot(f_grammarRoot),
+            m_reusedLength(0)
+        {
+        }
+
+        /// Parses f_input into f_out_parseTree (which should be empty, its
+        /// candidate limit is respected).
+        /// @returns the same result as f_grammarRoot->parse(f_input, f_out_parseTree)
+        ParseRc parse(const std::string & f_input, ParsedElement & f_out_parseTree)
+        {
+            m_reusedLength = 0;
+            if(canContinue(m_grammarRoot) and (m_previousTree.getGrammarElement() == m_grammarRoot))
+            {
+                m_reusedLength = reuseChildren(f_input, m_previousTree, 0, getStableEnd(f_input), f_out_parseTree);
+            }
+
+            ParseRc rc = m_grammarRoot->parse(f_input.c_str(), f_out_parseTree, 1, f_out_parseTree.getChildren().size());
+
+            // keep the result for the next parse. Copies share the children:
+            m_previousInput = f_input;
+            m_previousTree = f_out_parseTree;
+            m_previousTree.setParent(&m_previousTree);
+            return rc;
+        }
+
+        /// @returns number of input characters the last parse() did not need to parse again
+        size_t getReusedLength() const
+        {
+            return m_reusedLength;
+        }
+
+        /// Forgets the previous parse, e.g. after the grammar changed.
+        void reset()
+        {
+            m_previousInput.clear();
+            m_previousTree = ParsedElement();
+        }
+
+    private:
+        /// @returns true if parse() of f_element continues a continued child
+        static bool canContinue(GrammarElement * f_element)
+        {
+            return (dynamic_cast<Concatenation*>(f_element) != nullptr)
+                or (dynamic_cast<Repetition*>(f_element) != nullptr)
+                or (dynamic_cast<Optional*>(f_element) != nullptr)
+                or (dynamic_cast<GrammarInjector*>(f_element) != nullptr);
+        }
+
+        /// @returns offset of the last whitespace f_input and the previous
+        ///     input have in common, 0 if there is none. Parse results ending
+        ///     before it are also valid for f_input.
+        size_t getStableEnd(const std::string & f_input) const
+        {
+            size_t commonLength = 0;
+            while((commonLength < f_input.size()) and (commonLength < m_previousInput.size()) and (f_input[commonLength] == m_previousInput[commonLength]))
+            {
+                commonLength++;
+            }
+            size_t stableEnd = commonLength;
+            while((stableEnd > 0) and (not std::isspace(static_cast<unsigned char>(f_input[stableEnd - 1]))))
+            {
+                stableEnd--;
+            }
+            return (stableEnd > 0) ? (stableEnd - 1) : 0;
+        }
+
+        /// Shares the children of f_previous which end before f_stableEnd with
+        /// f_out and continues the child behind them, if possible.
+        /// @param f_start input offset at which f_previous starts
+        /// @returns input offset behind the re-used children, f_start if nothing is re-used
+        size_t reuseChildren(const std::string & f_input, ParsedElement & f_previous, size_t f_start, size_t f_stableEnd, ParsedElement & f_out)
+        {
+            const auto & children = f_previous.getChildren();
+            size_t offset = f_start;
+            size_t numReused = 0;
+            // the last child is always parsed again, it might be incomplete:
+            while(numReused + 1 < children.size())
+            {
+                const std::string childString = children[numReused]->getMatchedStringRaw();
+                // only trust the previous result if it matched the same input:
+                if((offset + childString.size() > f_stableEnd) or (f_input.compare(offset, childString.size(), childString) != 0))
+                {
+                    break;
+                }
+                offset += childString.size();
+                numReused++;
+            }
+            const size_t sharedEnd = offset;
+
+            std::shared_ptr<ParsedElement> continuedChild;
+            if((numReused < children.size()) and canContinue(children[numReused]->getGrammarElement()))
+            {
+                continuedChild = std::make_shared<ParsedElement>(&f_out);
+                size_t continuedEnd = reuseChildren(f_input, *children[numReused], offset, f_stableEnd, *continuedChild);
+                if(continuedEnd > offset)
+                {
+                    offset = continuedEnd;
+                }
+                else
+                {
+                    continuedChild.reset();
+                }
+            }
+            if(offset == f_start)
+            {
+                return f_start;
+            }
+
+            f_out.shareChildren(f_previous, numReused);
+            // they still point to the tree of the previous parse, which the caller may have destroyed:
+            for(auto child : f_out.getChildren())
+            {
+                child->setParent(&f_out);
+            }
+            f_out.setContinuedChild(continuedChild);
+            f_out.setReusedLength(sharedEnd - f_start);
+            return offset;
+        }
+
+        GrammarElement * m_grammarRoot;
+        std::string m_previousInput;
+        ParsedElement m_previousTree;
+        size_t m_reusedLength;
+};
+
+}
@@ -40,6 +40,7 @@ class Optional : public GrammarElement
 
         virtual ParseRc parse(const char * f_string, ParsedElement & f_out_ParsedElement, size_t candidateDepth = 1, size_t startChild = 0) override
         {
+            ParseProfiler::Scope profilerScope(m_instanceId);
             ParseRc rc;
             ParseRc childRc;
             f_out_ParsedElement.setGrammarElement(this);
@@ -53,9 +54,14 @@ class Optional : public GrammarElement
             }
 
             auto child = m_children[0]; // FIXME: range check
-            auto newParsedElement = std::make_shared<ParsedElement>(&f_out_ParsedElement);
+            // the child might continue the unfinished result of a previous parse:
+            std::shared_ptr<ParsedElement> newParsedElement = f_out_ParsedElement.takeContinuedChild();
+            if(newParsedElement == nullptr)
+            {
+                newParsedElement = std::make_shared<ParsedElement>(&f_out_ParsedElement);
+            }
             //printf("Optional start parse\n");
-            childRc = child->parse(&f_string[rc.lenParsedSuccessfully], *newParsedElement);
+            childRc = child->parse(&f_string[rc.lenParsedSuccessfully], *newParsedElement, 1, newParsedElement->getChildren().size());
             //printf("Optional parse RC: ");
             //childRc.print();
             //printf("\n");
@@ -0,0 +1,184 @@
+// Copyright 2019 IBM Corporation
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <vector>
+
+namespace ArgParse
+{
+/// Optional self-profiling of GrammarElement::parse().
+/// If enabled, every parse() call records its duration and the number of
+/// ParsedElements constructed, keyed by the instance ID of the GrammarElement.
+/// Self time and self ParsedElements exclude nested parse() calls of other
+/// elements, so hot elements can be identified directly.
+/// Disabled by default, costs a single flag check per parse() call then.
+class ParseProfiler
+{
+    public:
+        struct ElementStatistics
+        {
+            uint64_t calls = 0;
+            /// time including nested parse() calls of other elements.
+            /// Recursive calls of the same element are only counted once.
+            std::chrono::steady_clock::duration totalTime = std::chrono::steady_clock::duration::zero();
+            /// time excluding nested parse() calls of other elements
+            std::chrono::steady_clock::duration selfTime = std::chrono::steady_clock::duration::zero();
+            /// ParsedElements constructed by this element itself
+            uint64_t parsedElements = 0;
+        };
+
+        static void setEnabled(bool f_enabled)
+        {
+            getState().enabled.store(f_enabled);
+        }
+
+        static bool isEnabled()
+        {
+            return getState().enabled.load(std::memory_order_relaxed);
+        }
+
+        /// Discards all recorded statistics.
+        static void reset()
+        {
+            State & state = getState();
+            std::lock_guard<std::mutex> lock(state.mutex);
+            state.statistics.clear();
+        }
+
+        /// @returns recorded statistics keyed by GrammarElement instance ID
+        static std::map<uint32_t, ElementStatistics> getStatistics()
+        {
+            State & state = getState();
+            std::lock_guard<std::mutex> lock(state.mutex);
+            return state.statistics;
+        }
+
+        /// Attributes a newly constructed ParsedElement to the element currently parsing.
+        static void countParsedElement()
+        {
+            if(isEnabled())
+            {
+                std::vector<Frame> & stack = getStack();
+                if(not stack.empty())
+                {
+                    stack.back().parsedElements++;
+                }
+            }
+        }
+
+        /// Profiles a parse() call from construction to destruction.
+        class Scope
+        {
+            public:
+                explicit Scope(uint32_t f_instanceId) :
+                    m_enabled(isEnabled())
+                {
+                    if(m_enabled)
+                    {
+                        Frame frame;
+                        frame.instanceId = f_instanceId;
+                        frame.childTime = std::chrono::steady_clock::duration::zero();
+                        frame.parsedElements = 0;
+                        frame.start = std::chrono::steady_clock::now();
+                        getStack().push_back(frame);
+                    }
+                }
+
+                ~Scope()
+                {
+                    if(m_enabled)
+                    {
+                        popFrame(std::chrono::steady_clock::now());
+                    }
+                }
+
+                Scope(const Scope &) = delete;
+                Scope & operator=(const Scope &) = delete;
+
+            private:
+                bool m_enabled;
+        };
+
+    private:
+        struct Frame
+        {
+            uint32_t instanceId;
+            std::chrono::steady_clock::time_point start;
+            std::chrono::steady_clock::duration childTime;
+            uint64_t parsedElements;
+        };
+
+        struct State
+        {
+            State() :
+                enabled(false)
+            {
+            }
+            std::atomic<bool> enabled;
+            std::mutex mutex;
+            std::map<uint32_t, ElementStatistics> statistics;
+        };
+
+        static State & getState()
+        {
+            static State state;
+            return state;
+        }
+
+        static std::vector<Frame> & getStack()
+        {
+            static thread_local std::vector<Frame> stack;
+            return stack;
+        }
+
+        static void popFrame(std::chrono::steady_clock::time_point f_end)
+        {
+            std::vector<Frame> & stack = getStack();
+            Frame frame = stack.back();
+            stack.pop_back();
+            std::chrono::steady_clock::duration totalTime = f_end - frame.start;
+
+            bool recursive = false;
+            for(const Frame & outerFrame : stack)
+            {
+                if(outerFrame.instanceId == frame.instanceId)
+                {
+                    recursive = true;
+                    break;
+                }
+            }
+            if(not stack.empty())
+            {
+                stack.back().childTime += totalTime;
+            }
+
+            State & state = getState();
+            std::lock_guard<std::mutex> lock(state.mutex);
+            ElementStatistics & statistics = state.statistics[frame.instanceId];
+            statistics.calls++;
+            if(not recursive)
+            {
+                statistics.totalTime += totalTime;
+            }
+            statistics.selfTime += totalTime - frame.childTime;
+            statistics.parsedElements += frame.parsedElements;
+        }
+};
+}
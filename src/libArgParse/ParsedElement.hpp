@@ -14,10 +14,12 @@
 
 #pragma once
 #include <libArgParse/GrammarElement.hpp>
+#include <libArgParse/ParseProfiler.hpp>
 #include <vector>
 #include <string>
 #include <memory>
 #include <limits>
+#include <algorithm>
 
 namespace ArgParse
 {
@@ -26,22 +28,205 @@ class GrammarElement;
 class ParsedElement
 {
     public:
+        /// List of children which can share a prefix with the children of
+        /// another ParsedElement in O(1) (see ParsedElement::shareChildren()).
+        ///
+        /// The children are stored in a reference counted vector, which is
+        /// allocated with the first child. Only one list (the writer) appends
+        /// to that vector. All other lists sharing it
+        /// see a fixed prefix of it and keep children appended by themselves
+        /// in a separate vector (the delta). Existing entries never change, so
+        /// a prefix stays valid while the writer keeps appending.
+        /// Not thread-safe: lists sharing a prefix must be used from one thread.
+        class ChildList
+        {
+            public:
+                typedef std::vector<std::shared_ptr<ParsedElement> > Store;
+
+                class const_iterator
+                {
+                    public:
+                        const_iterator(const ChildList * f_list, size_t f_index) :
+                            m_list(f_list),
+                            m_index(f_index)
+                        {
+                        }
+
+                        const std::shared_ptr<ParsedElement> & operator*() const
+                        {
+                            return (*m_list)[m_index];
+                        }
+
+                        const std::shared_ptr<ParsedElement> * operator->() const
+                        {
+                            return &(*m_list)[m_index];
+                        }
+
+                        const_iterator & operator++()
+                        {
+                            m_index++;
+                            return *this;
+                        }
+
+                        bool operator==(const const_iterator & f_other) const
+                        {
+                            return (m_list == f_other.m_list) and (m_index == f_other.m_index);
+                        }
+
+                        bool operator!=(const const_iterator & f_other) const
+                        {
+                            return not (*this == f_other);
+                        }
+
+                    private:
+                        const ChildList * m_list;
+                        size_t m_index;
+                };
+
+                ChildList() :
+                    m_sharedSize(0),
+                    m_writer(true)
+                {
+                }
+
+                /// The copy shares all children of f_other, only f_other
+                /// stays writer of the shared vector.
+                ChildList(const ChildList & f_other) :
+                    m_shared(f_other.m_shared),
+                    m_sharedSize(f_other.m_writer ? f_other.getSharedSize() : f_other.m_sharedSize),
+                    m_writer(false),
+                    m_delta(f_other.m_delta)
+                {
+                }
+
+                ChildList & operator=(const ChildList & f_other)
+                {
+                    if(this != &f_other)
+                    {
+                        m_shared = f_other.m_shared;
+                        m_sharedSize = f_other.m_writer ? f_other.getSharedSize() : f_other.m_sharedSize;
+                        m_writer = false;
+                        m_delta = f_other.m_delta;
+                    }
+                    return *this;
+                }
+
+                size_t size() const
+                {
+                    return m_writer ? getSharedSize() : (m_sharedSize + m_delta.size());
+                }
+
+                bool empty() const
+                {
+                    return (size() == 0);
+                }
+
+                const std::shared_ptr<ParsedElement> & operator[](size_t f_index) const
+                {
+                    if(m_writer or (f_index < m_sharedSize))
+                    {
+                        return (*m_shared)[f_index];
+                    }
+                    return m_delta[f_index - m_sharedSize];
+                }
+
+                const std::shared_ptr<ParsedElement> & back() const
+                {
+                    return (*this)[size() - 1];
+                }
+
+                const_iterator begin() const
+                {
+                    return const_iterator(this, 0);
+                }
+
+                const_iterator end() const
+                {
+                    return const_iterator(this, size());
+                }
+
+                void push_back(const std::shared_ptr<ParsedElement> & f_element)
+                {
+                    if(m_writer)
+                    {
+                        if(not m_shared)
+                        {
+                            m_shared = std::make_shared<Store>();
+                        }
+                        m_shared->push_back(f_element);
+                    }
+                    else
+                    {
+                        m_delta.push_back(f_element);
+                    }
+                }
+
+                /// Replaces this list by the first f_numChildren children of f_other.
+                /// O(1), unless f_other has a delta itself. Then f_other is
+                /// converted to the writer of a new vector first (once).
+                void share(ChildList & f_other, size_t f_numChildren)
+                {
+                    size_t numChildren = std::min(f_numChildren, f_other.size());
+                    if((not f_other.m_writer) and (numChildren > f_other.m_sharedSize))
+                    {
+                        f_other.becomeWriter();
+                    }
+                    m_shared = f_other.m_shared;
+                    m_sharedSize = numChildren;
+                    m_writer = false;
+                    m_delta.clear();
+                }
+
+            private:
+                size_t getSharedSize() const
+                {
+                    return m_shared ? m_shared->size() : 0;
+                }
+
+                void becomeWriter()
+                {
+                    std::shared_ptr<Store> store = std::make_shared<Store>();
+                    store->reserve(m_sharedSize + m_delta.size());
+                    if(m_shared)
+                    {
+                        store->insert(store->end(), m_shared->begin(), m_shared->begin() + m_sharedSize);
+                    }
+                    store->insert(store->end(), m_delta.begin(), m_delta.end());
+                    m_shared = store;
+                    m_sharedSize = 0;
+                    m_writer = true;
+                    m_delta.clear();
+                }
+
+                /// nullptr until the first child is added
+                std::shared_ptr<Store> m_shared;
+                /// number of visible entries of m_shared (if not writer)
+                size_t m_sharedSize;
+                /// true if this list appends to m_shared directly
+                bool m_writer;
+                /// children appended by this list (if not writer)
+                Store m_delta;
+        };
+
         ParsedElement() :
             m_grammarElement(nullptr),
             m_parent(this)
         {
+            ParseProfiler::countParsedElement();
         }
 
         explicit ParsedElement(ParsedElement * f_parent) :
             m_grammarElement(nullptr),
             m_parent(f_parent)
         {
+            ParseProfiler::countParsedElement();
         }
 
         explicit ParsedElement(GrammarElement * f_grammarElement) :
             m_grammarElement(f_grammarElement),
             m_parent(this)
         {
+            ParseProfiler::countParsedElement();
         }
 
         GrammarElement * getGrammarElement()
@@ -104,11 +289,53 @@ class ParsedElement
         std::string getDebugString(const std::string & f_prefix = "");
 
         /// Returns a list of children.
-        std::vector<std::shared_ptr<ParsedElement> > & getChildren()
+        const ChildList & getChildren() const
         {
             return m_children;
         }
 
+        /// Makes the first f_numChildren children of f_other the children of
+        /// this element, replacing the current ones.
+        /// The children are shared (not copied), so this is O(1). Children
+        /// added later to one of the elements are not seen by the other one.
+        /// The parent of the shared children is not changed.
+        void shareChildren(ParsedElement & f_other, size_t f_numChildren = std::numeric_limits<size_t>::max())
+        {
+            m_children.share(f_other.m_children, f_numChildren);
+        }
+
+        /// Sets an unfinished child from a previous parse, which the next
+        /// GrammarElement::parse() into this element continues instead of
+        /// parsing the child from scratch (see IncrementalParser).
+        /// The children of f_child are the re-used results of the first
+        /// grammar children, see setReusedLength().
+        void setContinuedChild(const std::shared_ptr<ParsedElement> & f_child)
+        {
+            m_continuedChild = f_child;
+        }
+
+        /// @returns the child set with setContinuedChild() and forgets it,
+        ///     nullptr if there is none
+        std::shared_ptr<ParsedElement> takeContinuedChild()
+        {
+            std::shared_ptr<ParsedElement> result;
+            result.swap(m_continuedChild);
+            return result;
+        }
+
+        /// Sets the number of input characters matched by the children this
+        /// element already has when GrammarElement::parse() continues it.
+        void setReusedLength(size_t f_length)
+        {
+            m_reusedLength = f_length;
+        }
+
+        /// @returns see setReusedLength()
+        size_t getReusedLength() const
+        {
+            return m_reusedLength;
+        }
+
         /// depth first search for a single element, directly returning the matched string.
         /// @param f_elementName element name to search for (inherited from grammar element)
         /// @param f_depth The maximum depth which should still be searched.
@@ -156,6 +383,9 @@ class ParsedElement
         /// get docString of right most node in the subtree
         std::string getShortDocument() const;
 
+        /// @returns true if getShortDocument() is not empty, without copying the docString
+        bool hasShortDocument() const;
+
         void setParent(ParsedElement * f_parent)
         {
             m_parent = f_parent;
@@ -188,6 +418,29 @@ class ParsedElement
                 m_children.back()->setStops();
             }
         }
+
+        /// @returns the element marked by setStops(), i.e. the last leaf of this tree
+        ParsedElement & getLastLeaf()
+        {
+            ParsedElement * result = this;
+            while(result->m_children.size() != 0)
+            {
+                result = result->m_children.back().get();
+            }
+            return *result;
+        }
+
+        /// @returns true if this element itself was marked by setStops()
+        bool stops() const
+        {
+            return m_stops;
+        }
+
+        /// Removes the mark set by setStops() from this element (not from its children)
+        void clearStops()
+        {
+            m_stops = false;
+        }
         bool isStopped() const
         {
             if(m_stops)
@@ -205,6 +458,31 @@ class ParsedElement
             return false;
         }
 
+        /// Limits the number of completion candidates collected while parsing
+        /// into this parse tree. Only evaluated on the root element.
+        /// Elements which could return more candidates return only f_limit + 1
+        /// candidates, so callers still see that a choice is not unique.
+        /// Alternations prefer documented candidates when dropping the others.
+        void setCandidateLimit(size_t f_limit)
+        {
+            m_candidateLimit = f_limit;
+        }
+
+        /// @returns the candidate limit of the root element
+        size_t getCandidateLimit() const
+        {
+            const ParsedElement * root = (m_parent == this) ? this : getRoot();
+            return root->m_candidateLimit;
+        }
+
+        /// @returns the maximum number of candidates an element should
+        ///  return when parsing into this element (see setCandidateLimit())
+        size_t getMaxCandidates() const
+        {
+            size_t limit = getCandidateLimit();
+            return (limit == std::numeric_limits<size_t>::max()) ? limit : (limit + 1);
+        }
+
         void setIncompleteParse()
         {
             m_incompleteParse = true;
@@ -218,11 +496,14 @@ class ParsedElement
     private:
         GrammarElement * m_grammarElement;
         ParsedElement * m_parent;
-        std::vector< std::shared_ptr<ParsedElement> > m_children;
+        ChildList m_children;
         bool m_stops = false;
         std::string m_matchedStringRaw;
         std::string m_matchedStringUnEscaped;
         bool m_incompleteParse = false;
+        size_t m_candidateLimit = std::numeric_limits<size_t>::max();
+        std::shared_ptr<ParsedElement> m_continuedChild;
+        size_t m_reusedLength = 0;
 };
 
 }
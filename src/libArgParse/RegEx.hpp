@@ -14,6 +14,8 @@
 
 #pragma once
 #include <libArgParse/GrammarElement.hpp>
+#include <memory>
+#include <mutex>
 
 #ifdef BUILD_CONFIG_USE_BOOST_REGEX
     #include <boost/regex.hpp>
@@ -46,7 +48,6 @@ class RegEx : public GrammarElement
 
         RegEx(const std::string & f_regEx, const std::string & f_elementName = "") :
             GrammarElement("RegEx", f_elementName),
-            m_regEx(f_regEx),
             m_regExString(f_regEx)
         {
         }
@@ -74,6 +75,7 @@ class RegEx : public GrammarElement
 
         virtual ParseRc parse(const char * f_string, ParsedElement & f_out_ParsedElement, size_t candidateDepth = 1, size_t startChild = 0) override
         {
+            ParseProfiler::Scope profilerScope(m_instanceId);
             ParseRc rc;
             ParseRc childRc;
             f_out_ParsedElement.setGrammarElement(this);
@@ -82,7 +84,7 @@ class RegEx : public GrammarElement
             regex::cmatch match;
             if(
                     //std::regex_search(f_string, match, m_regEx)
-                    regex::regex_search(f_string, match, m_regEx)
+                    regex::regex_search(f_string, match, getRegEx())
                     and
                     (match.position() == 0)
               )
@@ -119,8 +121,20 @@ class RegEx : public GrammarElement
             return result;
         }
     private:
-        //const std::regex m_regEx;
-        const regex::regex m_regEx;
+        /// Compiles the regex on first use. Most regexes of a large grammar
+        /// are never used in a single parse, so this keeps grammar
+        /// construction cheap. Thread safe.
+        const regex::regex & getRegEx()
+        {
+            std::call_once(m_compileOnce, [this]()
+            {
+                m_regEx.reset(new regex::regex(m_regExString));
+            });
+            return *m_regEx;
+        }
+
+        std::once_flag m_compileOnce;
+        std::unique_ptr<const regex::regex> m_regEx;
         const std::string m_regExString;
 };
 
@@ -36,6 +36,7 @@ class Repetition : public GrammarElement
 
         virtual ParseRc parse(const char * f_string, ParsedElement & f_out_ParsedElement, size_t candidateDepth = 1, size_t startChild = 0) override
         {
+            ParseProfiler::Scope profilerScope(m_instanceId);
             //printf("rep parse\n");
             ParseRc rc;
             ParseRc childRc;
@@ -46,7 +47,11 @@ class Repetition : public GrammarElement
             {
                 child = m_children[0];
             }
-            std::vector<std::shared_ptr<ParsedElement>> successfullyParsedChilds;
+            // the first numSuccessfullyParsedChilds children of f_out_ParsedElement.
+            // Children before startChild were parsed successfully by a previous parse:
+            size_t numSuccessfullyParsedChilds = startChild;
+            rc.lenParsed = f_out_ParsedElement.getReusedLength();
+            rc.lenParsedSuccessfully = rc.lenParsed;
             bool overParsed = false;
             while(childRc.isGood() && (child != nullptr) )
             {
@@ -58,9 +63,14 @@ class Repetition : public GrammarElement
                     // we set this flag here, to remember to switch the RC to success
                     overParsed = true;
                 }
-                auto newParsedElement = std::make_shared<ParsedElement>(&f_out_ParsedElement);
+                // the first repetition might continue the unfinished result of a previous parse:
+                std::shared_ptr<ParsedElement> newParsedElement = f_out_ParsedElement.takeContinuedChild();
+                if(newParsedElement == nullptr)
+                {
+                    newParsedElement = std::make_shared<ParsedElement>(&f_out_ParsedElement);
+                }
                 //printf("Optional start parse\n");
-                childRc = child->parse(&f_string[rc.lenParsedSuccessfully], *newParsedElement);
+                childRc = child->parse(&f_string[rc.lenParsedSuccessfully], *newParsedElement, 1, newParsedElement->getChildren().size());
                 //std::cout << " Rep "<< std::to_string(m_instanceId) <<  " parsed child. rc=" << childRc.toString() << std::endl;
                 //printf("Optional parse RC: ");
                 //childRc.print();
@@ -74,7 +84,7 @@ class Repetition : public GrammarElement
                 if(childRc.isGood())
                 {
                     // TODO: make unittest where those lists are different (partial parse should only complete partial result, but not append to successful list completions)
-                    successfullyParsedChilds.push_back(newParsedElement);
+                    numSuccessfullyParsedChilds++;
                 }
                 if(childRc.isBad())
                 {
@@ -96,11 +106,8 @@ class Repetition : public GrammarElement
                     auto realCandidate = std::make_shared<ParsedElement>(f_out_ParsedElement.getParent());
                     realCandidate->setGrammarElement(this);
                     realCandidate->setStops(); // think about this is this required for repetition?
-                    // add all previous childs (similar to concatenation):
-                    for (auto previousChild : successfullyParsedChilds)
-                    {
-                        realCandidate->addChild(previousChild);
-                    }
+                    // add all previous childs (similar to concatenation), shared with f_out_ParsedElement:
+                    realCandidate->shareChildren(f_out_ParsedElement, numSuccessfullyParsedChilds);
                     realCandidate->addChild(candidate);
                     //std::cout << " Rep "<< std::to_string(m_instanceId) <<  " add candidate '" << realCandidate->getMatchedString() << "'" << std::endl;
                     rc.candidates.push_back(realCandidate);
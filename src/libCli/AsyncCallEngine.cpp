@@ -0,0 +1,118 @@
+// Copyright 2019 IBM Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <libCli/AsyncCallEngine.hpp>
+
+#include <algorithm>
+
+namespace cli
+{
+
+namespace
+{
+    /// A unary call and its result. Deletes itself before the callback.
+    class UnaryCall : public AsyncCallEngine::Tag
+    {
+        public:
+            explicit UnaryCall(AsyncCallEngine::UnaryCallback f_onDone) :
+                m_onDone(f_onDone)
+            {
+            }
+
+            void proceed(bool f_ok) override
+            {
+                // Finish() always completes with ok == true, the status tells the outcome.
+                (void)f_ok;
+                // The reader lives in the arena of the call's ClientContext.
+                // The callback may destroy the context, so the reader is
+                // destroyed first and the callback gets the results as locals:
+                AsyncCallEngine::UnaryCallback onDone;
+                onDone.swap(m_onDone);
+                grpc::Status status = m_status;
+                grpc::ByteBuffer reply;
+                reply.Swap(&m_reply);
+                delete this;
+                onDone(status, reply);
+            }
+
+            std::unique_ptr<grpc::GenericClientAsyncResponseReader> m_reader;
+            grpc::ByteBuffer m_reply;
+            grpc::Status m_status;
+
+        private:
+            AsyncCallEngine::UnaryCallback m_onDone;
+    };
+}
+
+AsyncCallEngine::AsyncCallEngine(size_t f_numPollers) :
+    m_nextQueue(0)
+{
+    size_t numPollers = f_numPollers;
+    if(numPollers == 0)
+    {
+        numPollers = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    }
+    for(size_t i = 0; i < numPollers; i++)
+    {
+        m_completionQueues.emplace_back(new grpc::CompletionQueue());
+    }
+    for(size_t i = 0; i < numPollers; i++)
+    {
+        m_pollers.emplace_back(&AsyncCallEngine::poll, this, std::ref(*m_completionQueues[i]));
+    }
+}
+
+AsyncCallEngine::~AsyncCallEngine()
+{
+    for(std::unique_ptr<grpc::CompletionQueue> & cq : m_completionQueues)
+    {
+        cq->Shutdown();
+    }
+    for(std::thread & poller : m_pollers)
+    {
+        poller.join();
+    }
+}
+
+grpc::CompletionQueue * AsyncCallEngine::getCompletionQueue()
+{
+    return m_completionQueues[m_nextQueue++ % m_completionQueues.size()].get();
+}
+
+size_t AsyncCallEngine::getNumPollers() const
+{
+    return m_pollers.size();
+}
+
+void AsyncCallEngine::startUnaryCall(grpc::GenericStub & f_stub, grpc::ClientContext & f_context, const std::string & f_method, const grpc::ByteBuffer & f_request, UnaryCallback f_onDone)
+{
+    UnaryCall * call = new UnaryCall(f_onDone);
+    call->m_reader = f_stub.PrepareUnaryCall(&f_context, f_method, f_request, getCompletionQueue());
+    call->m_reader->StartCall();
+    call->m_reader->Finish(&call->m_reply, &call->m_status, call);
+}
+
+void AsyncCallEngine::poll(grpc::CompletionQueue & f_cq)
+{
+    void * tag;
+    bool ok;
+    // returns false only after Shutdown(), once the queue is drained:
+    while(f_cq.Next(&tag, &ok))
+    {
+        static_cast<Tag*>(tag)->proceed(ok);
+    }
+}
+
+}
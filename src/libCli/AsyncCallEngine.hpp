@@ -0,0 +1,95 @@
+// Copyright 2019 IBM Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#pragma once
+
+#include <grpcpp/grpcpp.h>
+#include <grpcpp/generic/generic_stub.h>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace cli
+{
+    /// Drives asynchronous gRPC calls with a fixed pool of poller threads.
+    ///
+    /// Each poller thread owns one completion queue. Calls are distributed
+    /// over the queues round robin, so many concurrent calls only need as many
+    /// threads as there are pollers.
+    /// Every asynchronous operation uses a Tag as its completion queue tag. When
+    /// the operation completes, the poller thread of the queue calls proceed()
+    /// on the tag, which typically advances the state machine of a call.
+    /// All operations of one call should use the same queue (see
+    /// getCompletionQueue()), so the events of a call are handled sequentially.
+    class AsyncCallEngine
+    {
+        public:
+            /// Completion queue tag. Events are delivered on a poller thread.
+            class Tag
+            {
+                public:
+                    virtual ~Tag()
+                    {
+                    }
+
+                    /// Called on a poller thread when the operation using this tag completed.
+                    /// @param f_ok the ok flag of the completion queue event
+                    virtual void proceed(bool f_ok) = 0;
+            };
+
+            /// Called on a poller thread when a unary call completed.
+            /// @param f_status status of the call
+            /// @param f_reply the reply message (empty if the call failed)
+            typedef std::function<void(const grpc::Status & f_status, grpc::ByteBuffer & f_reply)> UnaryCallback;
+
+            /// Starts the poller threads.
+            /// @param f_numPollers number of poller threads (and completion
+            ///        queues). 0 uses one per hardware thread.
+            explicit AsyncCallEngine(size_t f_numPollers = 0);
+
+            /// Shuts down all completion queues and joins the poller threads.
+            /// All calls must be finished (or cancelled and finished) before.
+            ~AsyncCallEngine();
+
+            AsyncCallEngine(const AsyncCallEngine &) = delete;
+            AsyncCallEngine & operator=(const AsyncCallEngine &) = delete;
+
+            /// @returns the completion queue to use for the next call (round robin)
+            grpc::CompletionQueue * getCompletionQueue();
+
+            size_t getNumPollers() const;
+
+            /// Starts a unary call.
+            /// @param f_stub stub to call on. Must outlive the call.
+            /// @param f_context context of the call (deadline, metadata,
+            ///        compression, ...). Must outlive the call and may be used to cancel it.
+            /// @param f_method full method name ("/package.Service/Method")
+            /// @param f_request serialized request message
+            /// @param f_onDone called once on a poller thread when the call completed.
+            ///        All resources of the call are released before, so the
+            ///        callback may destroy f_context and f_stub.
+            void startUnaryCall(grpc::GenericStub & f_stub, grpc::ClientContext & f_context, const std::string & f_method, const grpc::ByteBuffer & f_request, UnaryCallback f_onDone);
+
+        private:
+            void poll(grpc::CompletionQueue & f_cq);
+
+            std::vector<std::unique_ptr<grpc::CompletionQueue>> m_completionQueues;
+            std::vector<std::thread> m_pollers;
+            std::atomic<size_t> m_nextQueue;
+    };
+}
@@ -18,10 +18,20 @@
 #include <libCli/OutputFormatting.hpp>
 #include <libCli/ConnectionManager.hpp>
 #include <libCli/MessageParsing.hpp>
+#include <libCli/FormattingPipeline.hpp>
+#include <libCli/FieldProjection.hpp>
+#include <libCli/StreamAggregator.hpp>
+#include <libCli/Tracing.hpp>
+#include <libCli/FanOutCall.hpp>
+#include <libCli/SigintCancellation.hpp>
 #include "libCli/GrammarConstruction.hpp"
+#include <algorithm>
 #include <chrono>
 #include <ctime>
 #include <iomanip>
+#include <limits>
+#include <sstream>
+#include <thread>
 
 // for detecting if we are writing stdout to terminal or to pipe/file
 #include <stdio.h>
@@ -37,7 +47,7 @@ namespace cli
 {
 
 // TODO: move this to OutputFormatting code
-std::string customMessageFormat(const grpc::protobuf::Message & f_message, const grpc::protobuf::Descriptor* f_messageDescriptor, ParsedElement & f_customFormatParseTree, size_t startChild = 0)
+std::string customMessageFormat(const grpc::protobuf::Message & f_message, const grpc::protobuf::Descriptor* f_messageDescriptor, ParsedElement & f_customFormatParseTree, OutputFormatter & f_formatter, size_t startChild)
 {
     std::string result;
     const google::protobuf::Reflection * reflection = f_message.GetReflection();
@@ -86,7 +96,7 @@ std::string customMessageFormat(const grpc::protobuf::Message & f_message, const
             {
                 //std::cout << " have repeated entry\n";
                 const google::protobuf::Message & subMessage = reflection->GetRepeatedMessage(f_message, partialField, j);
-                result += customMessageFormat(subMessage, partialField->message_type(), f_customFormatParseTree, startChild+1);
+                result += customMessageFormat(subMessage, partialField->message_type(), f_customFormatParseTree, f_formatter, startChild+1);
             }
             return result;
         }
@@ -94,7 +104,7 @@ std::string customMessageFormat(const grpc::protobuf::Message & f_message, const
         {
             //std::cout << "have message\n";
             const google::protobuf::Message & subMessage = reflection->GetMessage(f_message, partialField);
-            return customMessageFormat(subMessage, partialField->message_type(), f_customFormatParseTree, startChild+1);
+            return customMessageFormat(subMessage, partialField->message_type(), f_customFormatParseTree, f_formatter, startChild+1);
         }
         }
     }
@@ -103,9 +113,6 @@ std::string customMessageFormat(const grpc::protobuf::Message & f_message, const
     // context in which to evaluate field references :)
 
     //std::cout << "have field\n";
-    OutputFormatter myOutputFormatter;
-    myOutputFormatter.clearColorMap();
-
     bool haveFormatString = false;
     auto formatString = f_customFormatParseTree.findFirstSubTree("OutputFormatString", haveFormatString);
     if(not haveFormatString)
@@ -129,7 +136,7 @@ std::string customMessageFormat(const grpc::protobuf::Message & f_message, const
             }
             else
             {
-                result += myOutputFormatter.fieldValueToString(f_message, fieldRef, "", "", modifier);
+                result += f_formatter.fieldValueToString(f_message, fieldRef, "", "", modifier);
             }
         }
         else
@@ -142,6 +149,69 @@ std::string customMessageFormat(const grpc::protobuf::Message & f_message, const
     return result;
 }
 
+/// Adds all fields referenced by a custom output format to a field projection.
+/// @returns false if the referenced fields cannot be determined
+static bool addCustomFormatFieldsToProjection(ParsedElement & f_customFormatParseTree, const grpc::protobuf::Descriptor* f_messageDescriptor, FieldProjection & f_projection)
+{
+    // field references are relative to the target message. Like in
+    // customMessageFormat() the first empty target ends the target path:
+    std::string targetPath;
+    bool found = false;
+    ParsedElement targetList = f_customFormatParseTree.findFirstSubTree("TargetSpecifier", found);
+    for(auto target : targetList.getChildren())
+    {
+        std::string partialTarget = (target != nullptr) ? target->findFirstChild("PartialTarget") : "";
+        if(partialTarget == "")
+        {
+            break;
+        }
+        targetPath += partialTarget + ".";
+    }
+
+    bool haveFormatString = false;
+    auto formatString = f_customFormatParseTree.findFirstSubTree("OutputFormatString", haveFormatString);
+    if(not haveFormatString)
+    {
+        return false;
+    }
+    for(auto outputStatement : formatString.getChildren())
+    {
+        bool foundFieldReference = false;
+        auto fieldReference = outputStatement->findFirstSubTree("OutputFieldReference", foundFieldReference);
+        if(foundFieldReference)
+        {
+            std::string error;
+            if(not f_projection.addFieldPath(f_messageDescriptor, targetPath + fieldReference.getMatchedString(), error))
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/// Message and byte count of a stream, for reporting its throughput.
+struct StreamThroughput
+{
+    uint64_t messages = 0;
+    uint64_t bytes = 0;
+    std::chrono::steady_clock::time_point start;
+    std::chrono::steady_clock::time_point end;
+};
+
+static std::string getThroughputString(const std::string & f_streamName, const StreamThroughput & f_stream)
+{
+    double seconds = std::chrono::duration<double>(f_stream.end - f_stream.start).count();
+    std::ostringstream result;
+    result << f_streamName << ": " << f_stream.messages << " messages, " << f_stream.bytes << " bytes in "
+        << std::fixed << std::setprecision(2) << (seconds * 1000) << " ms";
+    if(seconds > 0)
+    {
+        result << " (" << (f_stream.messages / seconds) << " messages/s, " << (f_stream.bytes / seconds / 1e6) << " MB/s)";
+    }
+    return result.str();
+}
+
 std::string getTimeString()
 {
     // unfortunately std::chrono::system_clock::to_time_t() is not available
@@ -152,15 +222,62 @@ std::string getTimeString()
     return cstr ;
 }
 
+void configureOutputFormatter(ParsedElement & f_parseTree, OutputFormatter & f_formatter)
+{
+    // disable colored output if explicitly specified:
+    if(f_parseTree.findFirstChild("NoColor") != "")
+    {
+        f_formatter.clearColorMap();
+    }
+
+    // disable map output as key => value if explicitly specified:
+    if(f_parseTree.findFirstChild("NoSimpleMapOutput") != "")
+    {
+        f_formatter.disableSimpleMapOutput();
+    }
+
+    // automatically disable colored output, when outputting to something
+    // else than a terminal (pipes, files, etc.), except we explicitly
+    // request color mode:
+    if((not isatty(fileno(stdout))) and (f_parseTree.findFirstChild("Color") == ""))
+    {
+        f_formatter.clearColorMap();
+    }
+
+    // values beyond size_t saturate, i.e. do not limit the hexdump:
+    unsigned long long hexdumpLimit = getUnsignedOption(&f_parseTree, "HexdumpLimit", std::numeric_limits<size_t>::max());
+    f_formatter.setHexdumpLimit(static_cast<size_t>(std::min<unsigned long long>(hexdumpLimit, std::numeric_limits<size_t>::max())));
+}
+
 int call(ParsedElement & parseTree)
 {
+    // multiple servers or a hosts file: call all of them concurrently
+    if((parseTree.findFirstChild("HostsFile") != "") or (getServerUris(&parseTree).size() > 1))
+    {
+        return fanOutCall(parseTree);
+    }
+
     std::string serviceName = parseTree.findFirstChild("Service");
     std::string methodName = parseTree.findFirstChild("Method");
     bool argsExist;
     ParsedElement & methodArgs = parseTree.findFirstSubTree("MethodArgs", argsExist);
     std::string serverAddress = cli::getServerUri(&parseTree);
 
-    std::shared_ptr<grpc::Channel> channel = ConnectionManager::getInstance().getChannel(serverAddress);
+    // the lease keeps the call counted on the channel until we return:
+    size_t channelPoolSize = 1;
+    std::string channelPoolSizeStr = parseTree.findFirstChild("ChannelPoolSize");
+    if(channelPoolSizeStr != "")
+    {
+        channelPoolSize = std::stoul(channelPoolSizeStr);
+    }
+    ChannelSelection channelSelection = ChannelSelection::RoundRobin;
+    if(parseTree.findFirstChild("ChannelSelectionLeastOutstanding") != "")
+    {
+        channelSelection = ChannelSelection::LeastOutstanding;
+    }
+    ChannelOptions channelOptions = getChannelOptions(&parseTree);
+    ChannelLease channelLease = ConnectionManager::getInstance().acquireChannel(serverAddress, channelPoolSize, channelSelection, channelOptions);
+    std::shared_ptr<grpc::Channel> channel = channelLease.getChannel();
 
     if(not waitForChannelConnected(channel, getConnectTimeoutMs(&parseTree)))
     {
@@ -168,7 +285,11 @@ int call(ParsedElement & parseTree)
         return -1;
     }
 
-    const grpc::protobuf::ServiceDescriptor* service = ConnectionManager::getInstance().getDescPool(serverAddress)->FindServiceByName(serviceName);
+    const grpc::protobuf::ServiceDescriptor* service = nullptr;
+    {
+        TraceSpan reflectionSpan("reflection::FindServiceByName", "reflection");
+        service = ConnectionManager::getInstance().getDescPool(serverAddress)->FindServiceByName(serviceName);
+    }
     if(service == nullptr)
     {
         std::cerr << "Error: Service '" << serviceName << "' not found" << std::endl;
@@ -198,20 +319,142 @@ int call(ParsedElement & parseTree)
         requestMessages.push_back(&parseTree);
     }
 
+    // decide on message formatting method to use:
+    bool customOutputFormatRequested = false;
+    ParsedElement customFormatParseTree = parseTree.findFirstSubTree("CustomOutputFormat", customOutputFormatRequested);
+
+    // use built-in human readable output format, unless a custom format is requested.
+    // The formatter is set up once and reused for all messages of the reply stream.
+    cli::OutputFormatter messageFormatter;
+    configureOutputFormatter(parseTree, messageFormatter);
+
+    if(customOutputFormatRequested)
+    {
+        // custom output is never colored:
+        messageFormatter.clearColorMap();
+    }
+
+    std::string bytesOutputFile = parseTree.findFirstChild("BytesToFileName");
+    if(bytesOutputFile != "")
+    {
+        if(customOutputFormatRequested)
+        {
+            // field references of a custom output format are not tracked as field paths:
+            std::cerr << "Error: --bytesToFile cannot be combined with --customOutput. Use the 'raw' modifier and redirect stdout instead." << std::endl;
+            return -1;
+        }
+        if(not messageFormatter.setBytesOutputFile(parseTree.findFirstChild("BytesToFileField"), bytesOutputFile))
+        {
+            std::cerr << "Error: Could not open file '" << bytesOutputFile << "' for writing" << std::endl;
+            return -1;
+        }
+    }
+
+    // Optionally only decode the fields of the replies which are actually printed:
+    FieldProjection fieldProjection;
+    std::string fieldList = parseTree.findFirstChild("FieldProjection");
+    if(fieldList != "")
+    {
+        std::stringstream fieldListStream(fieldList);
+        std::string fieldPath;
+        while(std::getline(fieldListStream, fieldPath, ','))
+        {
+            std::string error;
+            if((fieldPath != "") and (not fieldProjection.addFieldPath(method->output_type(), fieldPath, error)))
+            {
+                std::cerr << "Error: " << error << std::endl;
+                return -1;
+            }
+        }
+        std::unordered_set<const google::protobuf::FieldDescriptor*> projectedFields;
+        fieldProjection.getFieldDescriptors(projectedFields);
+        messageFormatter.setFieldFilter(projectedFields);
+    }
+    else if(customOutputFormatRequested)
+    {
+        // the custom output format knows which fields it needs. If these cannot
+        // be determined, we fall back to decoding the complete message.
+        if(not addCustomFormatFieldsToProjection(customFormatParseTree, method->output_type(), fieldProjection))
+        {
+            fieldProjection = FieldProjection();
+        }
+    }
+
+    // Optionally aggregate values over the reply stream instead of printing every message:
+    std::unique_ptr<StreamAggregator> aggregator;
+    std::chrono::milliseconds aggregateInterval(0);
+    std::string aggregateList = parseTree.findFirstChild("Aggregate");
+    if(aggregateList != "")
+    {
+        aggregator.reset(new StreamAggregator());
+        std::stringstream aggregateListStream(aggregateList);
+        std::string aggregateSpec;
+        while(std::getline(aggregateListStream, aggregateSpec, ','))
+        {
+            std::string error;
+            if((aggregateSpec != "") and (not aggregator->addAggregate(method->output_type(), aggregateSpec, error)))
+            {
+                std::cerr << "Error: " << error << std::endl;
+                return -1;
+            }
+        }
+        // nothing is printed, so only the aggregated fields need to be decoded:
+        fieldProjection = FieldProjection();
+        aggregator->addFieldsToProjection(method->output_type(), fieldProjection);
+
+        std::string aggregateIntervalStr = parseTree.findFirstChild("AggregateInterval");
+        if(aggregateIntervalStr != "")
+        {
+            aggregateInterval = std::chrono::milliseconds(std::stoull(aggregateIntervalStr));
+        }
+    }
+
     // Prepare the RPC call:
     std::multimap<grpc::string, grpc::string> clientMetadata;
-    grpc::string serializedResponse;
+    grpc_compression_algorithm callCompression;
+    const char * callCompressionName = nullptr;
+    if(getCallCompression(&parseTree, callCompression) and grpc_compression_algorithm_name(callCompression, &callCompressionName))
+    {
+        // same as ClientContext::set_compression_algorithm(), which is not accessible through CliCall:
+        clientMetadata.emplace(GRPC_COMPRESSION_REQUEST_ALGORITHM_MD_KEY, callCompressionName);
+    }
+    grpc::ByteBuffer serializedResponse;
     std::multimap<grpc::string_ref, grpc::string_ref> serverMetadataA;
     std::multimap<grpc::string_ref, grpc::string_ref> serverMetadataB;
 
     std::string methodStr =  "/" + serviceName + "/" + methodName;
-    grpc::testing::CliCall call(channel, methodStr, clientMetadata);
-
-    // Write all request messages (multiple in case of request stream)
-    for(ArgParse::ParsedElement * messageParseTree : requestMessages)
+    std::string deadlineStr = parseTree.findFirstChild("Deadline");
+    std::chrono::steady_clock::time_point callStartTime = std::chrono::steady_clock::now();
+    // covers the complete RPC, to compare call latencies (e.g. with and without corking):
+    TraceSpan rpcSpan("RPC (start to finish)", "rpc");
+    // corking sends the initial metadata together with the first message:
+    bool corkInitialMetadata = (parseTree.findFirstChild("CorkInitialMetadata") != "");
+    TraceSpan startCallSpan("CliCall::CliCall", "rpc");
+    grpc::testing::CliCall call(channel, methodStr, clientMetadata, getDeadline(&parseTree), corkInitialMetadata);
+    startCallSpan.end();
+
+    // Ctrl+C cancels the call, the replies received so far are still printed:
+    SigintCancellation sigintCancellation([&call]()
     {
+        call.TryCancel();
+    });
+    size_t numReplies = 0;
+
+    // Write all request messages (multiple in case of request stream).
+    // Writes are pipelined: the next message is parsed and serialized while
+    // the previous one is still being sent. The last write closes the stream.
+    StreamThroughput requestStream;
+    requestStream.start = std::chrono::steady_clock::now();
+    bool requestStreamClosed = false;
+    for(size_t i = 0; i < requestMessages.size(); i++)
+    {
+        ArgParse::ParsedElement * messageParseTree = requestMessages[i];
         // read data from the parse tree into the protobuf message:
-        std::unique_ptr<grpc::protobuf::Message> message = cli::parseMessage(*messageParseTree, dynamicFactory, inputType);
+        std::unique_ptr<grpc::protobuf::Message> message;
+        {
+            TraceSpan span("parseMessage", "rpc");
+            message = cli::parseMessage(*messageParseTree, dynamicFactory, inputType);
+        }
 
         if(parseTree.findFirstChild("PrintParsedMessage") != "")
         {
@@ -223,83 +466,220 @@ int call(ParsedElement & parseTree)
         if(not message)
         {
             std::cerr << "Error: Error parsing method arguments -> aborting the call :-(" << std::endl;
+            call.FlushWrites();
             return -1;
         }
 
         // now we serialize the message:
         grpc::string serializedRequest;
+        TraceSpan serializeSpan("serializeRequest", "rpc");
         bool success = message->SerializeToString(&serializedRequest);
+        serializeSpan.end();
         if(not success)
         {
             std::cerr << "Error: Failed to serialize method arguments" << std::endl;
+            call.FlushWrites();
             return -1;
         }
 
-        call.Write(serializedRequest);
+        TraceSpan writeSpan("CliCall::Write", "rpc");
+        requestStreamClosed = (i + 1 == requestMessages.size());
+        if(not call.WritePipelined(serializedRequest, requestStreamClosed))
+        {
+            // call already ended (e.g. cancelled), the status is reported by Finish()
+            requestStreamClosed = true;
+            break;
+        }
+        requestStream.messages++;
+        requestStream.bytes += serializedRequest.size();
     }
 
     // End the request stream. (This is a limitation of gWhisper streaming support, as we sequentially stream all request messages, then end the stream and then handle the reply stream.) No async streaming is possible via this CLI at the moment.
-    call.WritesDone();
+    TraceSpan writesDoneSpan("CliCall::WritesDone", "rpc");
+    if(requestStreamClosed)
+    {
+        call.FlushWrites();
+    }
+    else
+    {
+        call.WritesDone();
+    }
+    writesDoneSpan.end();
+    requestStream.end = std::chrono::steady_clock::now();
 
-    // In a loop we read reply data from the reply stream:
-    // NOTE: in gRPC every RPC can be considered "streaming". Non-streaming RPCs
-    //  merely return one reply message.
-    bool init = true;
-    for (init = true; call.Read(&serializedResponse, init ? &serverMetadataA : nullptr); init= false)
+    // converts data received from the stream into a message and formats it:
+    const grpc::protobuf::Message * replyPrototype = dynamicFactory.GetPrototype(method->output_type());
+    // Replies are decoded directly from the received slices, without copying them.
+    auto formatReply = [&](const grpc::ByteBuffer & f_serializedResponse, cli::OutputFormatter & f_formatter) -> std::string
     {
-        // convert data received from stream into a message:
-        std::unique_ptr<grpc::protobuf::Message> replyMessage(dynamicFactory.GetPrototype(method->output_type())->New());
-        replyMessage->ParseFromString(serializedResponse);
+        std::unique_ptr<grpc::protobuf::Message> replyMessage(replyPrototype->New());
+        TraceSpan decodeSpan("decodeReply", "format");
+        if(fieldProjection.empty())
+        {
+            parseFromByteBuffer(f_serializedResponse, *replyMessage);
+        }
+        else
+        {
+            fieldProjection.parseFromByteBuffer(f_serializedResponse, replyMessage.get());
+        }
+        decodeSpan.end();
 
-        // print date/time of message reception:
-        std::cerr << getTimeString();
-        std::cerr << ": Received message:\n";
+        if(not customOutputFormatRequested)
+        {
+            TraceSpan span("OutputFormatter::messageToString", "format");
+            return f_formatter.messageToString(*replyMessage, method->output_type(), "| ", "| " );
+        }
+        else
+        {
+            //std::cout << customFormatParseTree.getDebugString();
+            // use user provided output format string
+            TraceSpan span("customMessageFormat", "format");
+            return customMessageFormat(*replyMessage, method->output_type(), customFormatParseTree, f_formatter);
+        }
+    };
 
-        // print out string representation of the message:
-        std::string msgString;
-        // decide on message formatting method to use:
-        bool customOutputFormatRequested = false;
-        ParsedElement customFormatParseTree = parseTree.findFirstSubTree("CustomOutputFormat", customOutputFormatRequested);
+    // prints date/time of message reception and the string representation of the message:
+    auto writeReply = [&](const std::string & f_receiveInfo, const std::string & f_msgString)
+    {
+        TraceSpan span("writeReply", "format");
+        std::cerr << f_receiveInfo;
         if(not customOutputFormatRequested)
         {
-            // use built-in human readable output format
-            cli::OutputFormatter messageFormatter;
+            std::cout << f_msgString << std::endl;
+        }
+        else
+        {
+            std::cout << f_msgString; // Omit endline here. This is an unwanted char when binary data is directed into a file.
+            std::cerr << std::endl; // ... but put and endline into stderr to keep the console output nice again.
+        }
+    };
+
+    // Optionally format reply streams on multiple threads. Output order is preserved.
+    // Data written to a bytes output file would be interleaved in arbitrary
+    // order, so multiple threads are only used without --bytesToFile.
+    size_t numFormatThreads = 1;
+    if(method->server_streaming() and (bytesOutputFile == ""))
+    {
+        // more threads than cores only add scheduling overhead:
+        unsigned long long maxFormatThreads = 2 * std::max(std::thread::hardware_concurrency(), 1u);
+        numFormatThreads = static_cast<size_t>(std::min(getUnsignedOption(&parseTree, "FormatThreads", 1), maxFormatThreads));
+    }
+    std::vector<cli::OutputFormatter> workerFormatters;
+    std::unique_ptr<FormattingPipeline> formattingPipeline;
+    if((numFormatThreads > 1) and (not aggregator))
+    {
+        // formatters cache state, so every worker gets its own:
+        workerFormatters.assign(numFormatThreads, messageFormatter);
+        formattingPipeline.reset(new FormattingPipeline(
+                    numFormatThreads,
+                    4 * numFormatThreads,
+                    [&](const grpc::ByteBuffer & f_serializedResponse, size_t f_workerIndex)
+                    {
+                        return formatReply(f_serializedResponse, workerFormatters[f_workerIndex]);
+                    },
+                    writeReply));
+    }
+
+    // prints the current state of the aggregates:
+    auto writeAggregates = [&]()
+    {
+        std::cerr << getTimeString() << ": Aggregated reply stream:\n";
+        std::cout << aggregator->getSummary() << std::endl;
+    };
+    // in aggregation mode the same message object is reused for all replies:
+    std::unique_ptr<grpc::protobuf::Message> aggregateMessage(replyPrototype->New());
+    std::chrono::steady_clock::time_point lastAggregateTime = std::chrono::steady_clock::now();
 
-            // disable colored output if explicitly specified:
-            if(parseTree.findFirstChild("NoColor") != "")
+    // In a loop we read reply data from the reply stream:
+    // NOTE: in gRPC every RPC can be considered "streaming". Non-streaming RPCs
+    //  merely return one reply message.
+    auto readReply = [&](bool f_init) -> bool
+    {
+        // the first read includes waiting for the server to respond:
+        TraceSpan span(f_init ? "CliCall::Read(first reply)" : "CliCall::Read", "rpc");
+        return call.Read(&serializedResponse, f_init ? &serverMetadataA : nullptr);
+    };
+    StreamThroughput replyStream;
+    replyStream.start = std::chrono::steady_clock::now();
+    bool init = true;
+    for (init = true; readReply(init); init= false)
+    {
+        numReplies++;
+        replyStream.bytes += serializedResponse.Length();
+        if(aggregator)
+        {
+            TraceSpan span("aggregateReply", "format");
+            if(fieldProjection.empty())
             {
-                messageFormatter.clearColorMap();
+                // only messages are counted, no need to decode anything
+                aggregator->countMessage();
             }
-
-            // disable map output as key => value if explicitly specified:
-            if(parseTree.findFirstChild("NoSimpleMapOutput") != "")
+            else
             {
-                messageFormatter.disableSimpleMapOutput();
+                aggregateMessage->Clear();
+                fieldProjection.parseFromByteBuffer(serializedResponse, aggregateMessage.get());
+                aggregator->addMessage(*aggregateMessage);
             }
 
-            // automatically disable colored output, when outputting to something
-            // else than a terminal (pipes, files, etc.), except we explicitly
-            // request color mode:
-            if((not isatty(fileno(stdout))) and (parseTree.findFirstChild("Color") == ""))
+            if(aggregateInterval.count() > 0)
             {
-                messageFormatter.clearColorMap();
+                std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+                if(now - lastAggregateTime >= aggregateInterval)
+                {
+                    writeAggregates();
+                    lastAggregateTime = now;
+                }
             }
+            continue;
+        }
 
-            msgString = messageFormatter.messageToString(*replyMessage, method->output_type(), "| ", "| " );
-            std::cout << msgString << std::endl;
+        std::string receiveInfo = getTimeString() + ": Received message:\n";
+        if(formattingPipeline)
+        {
+            // copying the buffer only references the received slices:
+            formattingPipeline->push(serializedResponse, std::move(receiveInfo));
         }
         else
         {
-            //std::cout << customFormatParseTree.getDebugString();
-            // use user provided output format string
-            msgString = customMessageFormat(*replyMessage, method->output_type(), customFormatParseTree);
-            std::cout << msgString; // Omit endline here. This is an unwanted char when binary data is directed into a file.
-            std::cerr << std::endl; // ... but put and endline into stderr to keep the console output nice again.
+            writeReply(receiveInfo, formatReply(serializedResponse, messageFormatter));
         }
     }
 
+    replyStream.end = std::chrono::steady_clock::now();
+    replyStream.messages = numReplies;
+
+    if(formattingPipeline)
+    {
+        // make sure all replies are written before printing the RPC status
+        formattingPipeline->finish();
+    }
+
+    if(aggregator)
+    {
+        writeAggregates();
+    }
+
     // reply stream finished -> finish the RPC:
+    TraceSpan finishSpan("CliCall::Finish", "rpc");
     grpc::Status status = call.Finish(&serverMetadataB);
+    finishSpan.end();
+    rpcSpan.end();
+
+    if(parseTree.findFirstChild("Timing") != "")
+    {
+        std::cerr << getThroughputString("Request stream", requestStream) << std::endl;
+        std::cerr << getThroughputString("Reply stream", replyStream) << std::endl;
+    }
+
+    std::string duration = std::to_string(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - callStartTime).count());
+    if(sigintCancellation.wasCancelled())
+    {
+        std::cerr << "RPC cancelled by user (SIGINT) after " << duration << " ms, received " << numReplies << " reply message(s)" << std::endl;
+    }
+    else if((deadlineStr != "") and (status.error_code() == grpc::StatusCode::DEADLINE_EXCEEDED))
+    {
+        std::cerr << "RPC deadline of " << deadlineStr << " ms exceeded, received " << numReplies << " reply message(s)" << std::endl;
+    }
 
     if(not status.ok())
     {
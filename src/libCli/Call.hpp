@@ -15,6 +15,9 @@
 #pragma once
 
 #include <libArgParse/ArgParse.hpp>
+#include <libCli/OutputFormatting.hpp>
+
+#include <string>
 
 namespace cli
 {
@@ -22,4 +25,14 @@ namespace cli
     /// @param f_parseTree Parse tree containing all relevant information for the call (server address, request message, options, ...).
     /// @returns 0 if RPC succeeded, -1 otherwise (including parse errors from parse tree and gRPC bad return code)
     int call(ArgParse::ParsedElement & f_parseTree);
+
+    /// Applies the output options from the parse tree (colors, map output, hexdump limit) to a formatter.
+    void configureOutputFormatter(ArgParse::ParsedElement & f_parseTree, OutputFormatter & f_formatter);
+
+    /// Formats a message according to a custom output format (see --customOutput).
+    /// Field values are formatted with f_formatter, so its options (e.g. hexdump limit) apply.
+    std::string customMessageFormat(const grpc::protobuf::Message & f_message, const grpc::protobuf::Descriptor* f_messageDescriptor, ArgParse::ParsedElement & f_customFormatParseTree, OutputFormatter & f_formatter, size_t startChild = 0);
+
+    /// @returns the current local date and time as string
+    std::string getTimeString();
 }
@@ -13,12 +13,118 @@
 // limitations under the License.
 
 #include <queue>
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <unordered_set>
 #include <libCli/Completion.hpp>
 
 using namespace ArgParse;
 
 namespace cli
 {
+    size_t getCompleteLimit(const std::string & f_args)
+    {
+        const std::string option = "--completeLimit=";
+        size_t pos = f_args.find(option);
+        while(pos != std::string::npos)
+        {
+            if((pos == 0) or (f_args[pos - 1] == ' '))
+            {
+                const char * value = f_args.c_str() + pos + option.size();
+                if(std::isdigit(static_cast<unsigned char>(*value)))
+                {
+                    size_t limit = std::strtoul(value, nullptr, 10);
+                    if(limit > 0)
+                    {
+                        return limit;
+                    }
+                }
+                return std::numeric_limits<size_t>::max();
+            }
+            pos = f_args.find(option, pos + 1);
+        }
+        return std::numeric_limits<size_t>::max();
+    }
+
+    struct Suggestion
+    {
+        std::string completion;
+        std::string documentation;
+    };
+
+    /// @returns the part of f_args after the last of the given delimiters
+    static std::string getCurrentToken(const std::string & f_args, const char * f_delimiters)
+    {
+        size_t start = f_args.find_last_of(f_delimiters);
+        return (start == std::string::npos) ? f_args : f_args.substr(start + 1);
+    }
+
+    /// @returns 0 if f_completion starts with f_token, 1 if it starts with
+    ///  f_token ignoring case, 2 otherwise
+    static int getPrefixMatchRank(const std::string & f_completion, const std::string & f_token)
+    {
+        if(f_completion.compare(0, f_token.size(), f_token) == 0)
+        {
+            return 0;
+        }
+        if((f_completion.size() >= f_token.size()) and std::equal(f_token.begin(), f_token.end(), f_completion.begin(), [](char a, char b)
+                    {
+                        return std::tolower(static_cast<unsigned char>(a)) == std::tolower(static_cast<unsigned char>(b));
+                    }))
+        {
+            return 1;
+        }
+        return 2;
+    }
+
+    /// Removes duplicate completions (the first one is kept) and, if more than
+    /// f_limit remain, keeps only the f_limit best ones. Suggestions matching the
+    /// current token as prefix rank first, then suggestions with documentation.
+    /// The order of the kept suggestions is not changed.
+    static void selectSuggestions(std::vector<Suggestion> & f_suggestions, const std::string & f_currentToken, size_t f_limit)
+    {
+        std::unordered_set<std::string> seen;
+        std::vector<Suggestion> unique;
+        unique.reserve(f_suggestions.size());
+        for(Suggestion & suggestion : f_suggestions)
+        {
+            if(seen.insert(suggestion.completion).second)
+            {
+                unique.push_back(std::move(suggestion));
+            }
+        }
+        f_suggestions.swap(unique);
+        if(f_suggestions.size() <= f_limit)
+        {
+            return;
+        }
+
+        std::vector<size_t> ranking(f_suggestions.size());
+        for(size_t i = 0; i < ranking.size(); i++)
+        {
+            ranking[i] = i;
+        }
+        auto rank = [&](size_t f_index)
+        {
+            const Suggestion & suggestion = f_suggestions[f_index];
+            return 2 * getPrefixMatchRank(suggestion.completion, f_currentToken) + (suggestion.documentation.empty() ? 1 : 0);
+        };
+        std::stable_sort(ranking.begin(), ranking.end(), [&](size_t a, size_t b)
+        {
+            return rank(a) < rank(b);
+        });
+        ranking.resize(f_limit);
+        std::sort(ranking.begin(), ranking.end());
+
+        std::vector<Suggestion> selected;
+        selected.reserve(f_limit);
+        for(size_t index : ranking)
+        {
+            selected.push_back(std::move(f_suggestions[index]));
+        }
+        f_suggestions.swap(selected);
+    }
     // This function modifies the candidate string, such that:
     // - Only the arguments after the user input are counted as suggestion
     // - Only one suggestion is completed at a a time
@@ -61,7 +167,7 @@ namespace cli
         return out_suggestion;
     }
 
-    void printFishCompletions(std::vector<std::shared_ptr<ParsedElement>> &f_candidates, ParsedElement &f_parseTree, const std::string &f_args, bool f_debug)
+    void printFishCompletions(std::vector<std::shared_ptr<ParsedElement>> &f_candidates, ParsedElement &f_parseTree, const std::string &f_args, bool f_debug, size_t f_limit)
     {
         // completion requested :)
         if (f_debug)
@@ -69,8 +175,8 @@ namespace cli
             std::cerr << "Input string \"" << f_args << std::endl;
         }
 
-        // List with all suggestions for this candidate. Used to eliminate duplicate suggestions
-        std::vector<std::string> suggestions;
+        // List with all suggestions. Duplicates are eliminated before printing
+        std::vector<Suggestion> suggestions;
 
         // size_t n = parseTree.getMatchedString().size();
         size_t n = f_args.size();
@@ -111,16 +217,6 @@ namespace cli
             bool isTrimmed = false;
             suggestion = getNextFishSuggestion(candidateStr, f_args, isTrimmed);
 
-            if (std::find(suggestions.begin(), suggestions.end(), suggestion) != suggestions.end())
-            {
-                // Skip duplicate suggestions, continue with next candidate
-                continue;
-            }
-            else
-            {
-                suggestions.push_back(suggestion);
-            }
-
             if (f_debug)
             {
                 printf("nospace! cand='%s', n=%zu, start=%zu, end = %zu\n", candidateStr.c_str(), n, start, end);
@@ -129,32 +225,35 @@ namespace cli
             // Only Add Documentation, if string was not trimmed
             // In most casesa trimmed String means, that we complete with " " or ":". Those symbols do not need an documentation, hence we need to
             // remove the documentation provided by the untrimmed candidate
-            if (suggestion != "" && suggestion.back() != ':' && !isTrimmed)
+            if (suggestion == "" || suggestion.back() == ':' || isTrimmed)
             {
-                if (!suggestionDoc.empty())
-                {
-                    suggestion = suggestion + "\t" + suggestionDoc;
-                }
+                suggestionDoc = "";
+            }
+            suggestions.push_back({suggestion, suggestionDoc});
+        }
+
+        selectSuggestions(suggestions, getCurrentToken(f_args, " "), f_limit);
+
+        for (const Suggestion &suggestion : suggestions)
+        {
+            std::string output = suggestion.completion;
+            if (!suggestion.documentation.empty())
+            {
+                output = output + "\t" + suggestion.documentation;
             }
 
             if (f_debug)
             {
-                printf("post: '%s'\n", suggestion.c_str());
+                printf("post: '%s'\n", output.c_str());
             }
 
             // NOTE: be careful when adding description (tab-delimiter) here, as
             // fish summarizes all options with same description
-            printf("%s\n", suggestion.c_str());
+            printf("%s\n", output.c_str());
         }
     }
 
-    struct Suggestion
-    {
-        std::string completion;
-        std::string documentation;
-    };
-
-    void printBashCompletions(std::vector<std::shared_ptr<ParsedElement>> &f_candidates, ParsedElement &f_parseTree, const std::string &f_args, bool f_debug)
+    void printBashCompletions(std::vector<std::shared_ptr<ParsedElement>> &f_candidates, ParsedElement &f_parseTree, const std::string &f_args, bool f_debug, size_t f_limit)
     {
         // completion requested :)
         if (f_debug)
@@ -218,7 +317,14 @@ namespace cli
             {
                 suggestion.documentation = "";
             }
-            // find the max length of suggestion and document for right-aligned
+            suggestions.push_back(suggestion);
+        }
+
+        selectSuggestions(suggestions, getCurrentToken(f_args, " =:,"), f_limit);
+
+        // find the max length of suggestion and document for right-aligned
+        for (const Suggestion &suggestion : suggestions)
+        {
             if (!suggestion.documentation.empty())
             {
                 if (maxSuggestionLen < suggestion.completion.size())
@@ -230,7 +336,6 @@ namespace cli
                     maxSuggestionDocLen = suggestion.documentation.size();
                 }
             }
-            suggestions.push_back(suggestion);
         }
 
         for (const Suggestion &suggestion : suggestions)
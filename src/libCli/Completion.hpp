@@ -15,6 +15,7 @@
 #pragma once
 #include <vector>
 #include <memory>
+#include <limits>
 #include <libArgParse/ArgParse.hpp>
 
 namespace cli
@@ -26,11 +27,15 @@ namespace cli
     /// @param f_parseTree the parstree which contains everything which could already be matched.
     /// @param f_args the string given by the user which awaits completion
     /// @param f_debug enables debug output if true
+    /// @param f_limit maximum number of printed suggestions. Duplicates are
+    ///        removed first. If more remain, suggestions starting with the
+    ///        current token and suggestions with documentation are preferred.
     void printBashCompletions(
             std::vector<std::shared_ptr<ArgParse::ParsedElement> > & f_candidates,
             ArgParse::ParsedElement & f_parseTree,
             const std::string & f_args,
-            bool f_debug
+            bool f_debug,
+            size_t f_limit = std::numeric_limits<size_t>::max()
             );
 
     // TODO: only one function with enum dialect argument
@@ -38,6 +43,14 @@ namespace cli
             std::vector<std::shared_ptr<ArgParse::ParsedElement> > & f_candidates,
             ArgParse::ParsedElement & f_parseTree,
             const std::string & f_args,
-            bool f_debug
+            bool f_debug,
+            size_t f_limit = std::numeric_limits<size_t>::max()
             );
+
+    /// Reads the value of --completeLimit= from the unparsed arguments.
+    /// The limit is needed while parsing (see
+    /// ArgParse::ParsedElement::setCandidateLimit()), so it cannot be taken
+    /// from the parse tree.
+    /// @returns the limit, or the maximum value of size_t if no (or a zero) limit is given
+    size_t getCompleteLimit(const std::string & f_args);
 }
@@ -0,0 +1,187 @@
+// Copyright 2019 IBM Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <libCli/ConnectionManager.hpp>
+#include <libCli/cliUtils.hpp>
+#include <libCli/Tracing.hpp>
+
+#include <algorithm>
+#include <functional>
+#include <thread>
+
+namespace cli
+{
+
+void ChannelOptions::applyTo(grpc::ChannelArguments & f_args) const
+{
+    if(maxSendMessageSize >= 0)
+    {
+        f_args.SetMaxSendMessageSize(maxSendMessageSize);
+    }
+    if(maxReceiveMessageSize >= 0)
+    {
+        f_args.SetMaxReceiveMessageSize(maxReceiveMessageSize);
+    }
+    if(compression != "")
+    {
+        f_args.SetCompressionAlgorithm(getCompressionAlgorithm(compression));
+    }
+    if(keepaliveTimeMs >= 0)
+    {
+        f_args.SetInt(GRPC_ARG_KEEPALIVE_TIME_MS, keepaliveTimeMs);
+    }
+    if(bdpProbe >= 0)
+    {
+        f_args.SetInt(GRPC_ARG_HTTP2_BDP_PROBE, bdpProbe);
+    }
+    if(initialStreamWindowSize >= 0)
+    {
+        f_args.SetInt(GRPC_ARG_HTTP2_STREAM_LOOKAHEAD_BYTES, initialStreamWindowSize);
+    }
+}
+
+std::string ChannelOptions::getKey() const
+{
+    std::string key;
+    auto addInt = [&key](const char * f_name, int f_value)
+    {
+        if(f_value >= 0)
+        {
+            key += std::string(f_name) + "=" + std::to_string(f_value) + ";";
+        }
+    };
+    addInt("maxSend", maxSendMessageSize);
+    addInt("maxReceive", maxReceiveMessageSize);
+    if(compression != "")
+    {
+        key += "compression=" + compression + ";";
+    }
+    addInt("keepalive", keepaliveTimeMs);
+    addInt("bdpProbe", bdpProbe);
+    addInt("streamWindow", initialStreamWindowSize);
+    return key;
+}
+
+std::shared_ptr<ConnectionManager::Entry> ConnectionManager::getEntry(const std::string & f_serverAddress, const ChannelOptions & f_options)
+{
+    // channels with different tuning must not be shared:
+    std::string optionsKey = f_options.getKey();
+    std::string key = optionsKey.empty() ? f_serverAddress : (f_serverAddress + " " + optionsKey);
+    Shard & shard = m_shards[std::hash<std::string>()(key) % s_numShards];
+    std::shared_ptr<Entry> entry;
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        std::shared_ptr<Entry> & slot = shard.entries[key];
+        if(not slot)
+        {
+            slot = std::make_shared<Entry>();
+        }
+        entry = slot;
+    }
+    // creation happens outside of the shard lock, concurrent callers for the
+    // same address wait here until the first one is done:
+    std::call_once(entry->initFlag, &ConnectionManager::registerConnection, std::cref(f_serverAddress), std::cref(f_options), std::ref(entry->connList));
+    return entry;
+}
+
+const ConnList & ConnectionManager::getConnection(const std::string & f_serverAddress, const ChannelOptions & f_options)
+{
+    // entries are never removed, so the reference stays valid:
+    return getEntry(f_serverAddress, f_options)->connList;
+}
+
+ChannelLease ConnectionManager::acquireChannel(const std::string & f_serverAddress, size_t f_poolSize, ChannelSelection f_selection, const ChannelOptions & f_options)
+{
+    std::shared_ptr<Entry> entry = getEntry(f_serverAddress, f_options);
+    const size_t poolSize = std::max<size_t>(f_poolSize, 1);
+
+    std::lock_guard<std::mutex> lock(entry->poolMutex);
+    if(entry->channelPool.empty())
+    {
+        entry->channelPool.push_back(entry->connList.channel);
+        entry->outstandingCalls.push_back(std::make_shared<std::atomic<uint32_t>>(0));
+    }
+    while(entry->channelPool.size() < poolSize)
+    {
+        TraceSpan span("ConnectionManager::createPoolChannel", "connection");
+        grpc::ChannelArguments args;
+        f_options.applyTo(args);
+        // gRPC shares subchannels (and therefore connections) between channels
+        // with identical arguments. A local subchannel pool and an argument
+        // unique to each pool channel ensure every channel connects separately:
+        args.SetInt("grpc.use_local_subchannel_pool", 1);
+        args.SetInt("gwhisper.channel_pool_index", static_cast<int>(entry->channelPool.size()));
+        entry->channelPool.push_back(grpc::CreateCustomChannel(f_serverAddress, grpc::InsecureChannelCredentials(), args));
+        entry->outstandingCalls.push_back(std::make_shared<std::atomic<uint32_t>>(0));
+    }
+
+    // start searching at the next round robin position, so that equally
+    // loaded channels are used in turn:
+    const size_t start = entry->nextPoolIndex % poolSize;
+    entry->nextPoolIndex = start + 1;
+    size_t selected = start;
+    if(f_selection == ChannelSelection::LeastOutstanding)
+    {
+        for(size_t i = 1; i < poolSize; i++)
+        {
+            size_t candidate = (start + i) % poolSize;
+            if(entry->outstandingCalls[candidate]->load() < entry->outstandingCalls[selected]->load())
+            {
+                selected = candidate;
+            }
+        }
+    }
+    return ChannelLease(entry->channelPool[selected], entry->outstandingCalls[selected]);
+}
+
+void ConnectionManager::registerConnection(const std::string & f_serverAddress, const ChannelOptions & f_options, ConnList & f_out_connection)
+{
+    TraceSpan span("ConnectionManager::registerConnection", "connection");
+    grpc::ChannelArguments args;
+    f_options.applyTo(args);
+    f_out_connection.channel = grpc::CreateCustomChannel(f_serverAddress, grpc::InsecureChannelCredentials(), args);
+    f_out_connection.descDb = std::make_shared<grpc::ProtoReflectionDescriptorDatabase>(f_out_connection.channel);
+    f_out_connection.descPool = std::make_shared<grpc::protobuf::DescriptorPool>(f_out_connection.descDb.get());
+}
+
+std::vector<bool> ConnectionManager::prewarm(const std::vector<std::string> & f_serverAddresses, uint32_t f_timeoutMs, const ChannelOptions & f_options)
+{
+    TraceSpan span("ConnectionManager::prewarm", "connection");
+    // std::vector<bool> can not be written concurrently:
+    std::vector<char> succeeded(f_serverAddresses.size(), 0);
+    std::vector<std::thread> threads;
+    threads.reserve(f_serverAddresses.size());
+    for(size_t i = 0; i < f_serverAddresses.size(); i++)
+    {
+        threads.emplace_back([this, &f_serverAddresses, &f_options, &succeeded, i, f_timeoutMs]()
+            {
+                const ConnList & connection = getConnection(f_serverAddresses[i], f_options);
+                if(not waitForChannelConnected(connection.channel, f_timeoutMs))
+                {
+                    return;
+                }
+                TraceSpan serviceSpan("reflection::ListServices", "reflection");
+                std::vector<grpc::string> services;
+                succeeded[i] = connection.descDb->GetServices(&services) ? 1 : 0;
+            });
+    }
+    for(auto & thread : threads)
+    {
+        thread.join();
+    }
+    return std::vector<bool>(succeeded.begin(), succeeded.end());
+}
+
+}
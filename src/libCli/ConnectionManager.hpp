@@ -15,6 +15,15 @@
 #pragma once
 
 #include <third_party/gRPC_utils/proto_reflection_descriptor_database.h>
+#include <grpcpp/support/channel_arguments.h>
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 namespace cli
 {
@@ -27,7 +36,80 @@ namespace cli
 
     } ConnList;
 
+    /// Tuning of the channels created by the ConnectionManager.
+    /// Values < 0 (or an empty compression) keep the gRPC defaults.
+    struct ChannelOptions
+    {
+        /// maximum size of a sent message in bytes
+        int maxSendMessageSize = -1;
+        /// maximum size of a received message in bytes (gRPC default: 4 MB)
+        int maxReceiveMessageSize = -1;
+        /// default compression algorithm of all calls on the channel: "none", "deflate" or "gzip"
+        std::string compression;
+        /// period in milliseconds after which a keepalive ping is sent on the transport
+        int keepaliveTimeMs = -1;
+        /// 0 disables the HTTP/2 bandwidth delay product probing, which grows the flow control windows
+        int bdpProbe = -1;
+        /// initial HTTP/2 flow control window of each stream in bytes
+        int initialStreamWindowSize = -1;
+
+        /// Adds all options which are set to the given channel arguments.
+        void applyTo(grpc::ChannelArguments & f_args) const;
+
+        /// @returns a string identifying the options, empty if all defaults are kept.
+        std::string getKey() const;
+    };
+
+    /// Strategies to select a channel from the channel pool of a server.
+    enum class ChannelSelection
+    {
+        /// channels are handed out one after another
+        RoundRobin,
+        /// the channel with the least calls in progress is handed out
+        LeastOutstanding
+    };
+
+    /// A channel handed out from a channel pool. The call is counted as
+    /// outstanding on the channel until the lease is destroyed.
+    class ChannelLease
+    {
+        public:
+            ChannelLease(std::shared_ptr<grpc::Channel> f_channel, std::shared_ptr<std::atomic<uint32_t>> f_outstandingCalls) :
+                m_channel(f_channel),
+                m_outstandingCalls(f_outstandingCalls)
+            {
+                m_outstandingCalls->fetch_add(1);
+            }
+            ChannelLease(const ChannelLease & ) = delete;
+            ChannelLease& operator=(const ChannelLease & ) = delete;
+            ChannelLease(ChannelLease && f_other) :
+                m_channel(std::move(f_other.m_channel)),
+                m_outstandingCalls(std::move(f_other.m_outstandingCalls))
+            {
+            }
+            ~ChannelLease()
+            {
+                if(m_outstandingCalls)
+                {
+                    m_outstandingCalls->fetch_sub(1);
+                }
+            }
+
+            std::shared_ptr<grpc::Channel> getChannel() const
+            {
+                return m_channel;
+            }
+
+        private:
+            std::shared_ptr<grpc::Channel> m_channel;
+            std::shared_ptr<std::atomic<uint32_t>> m_outstandingCalls;
+    };
+
     /// Class to manage and resuse connection information, singleton pattern.
+    /// All methods are thread-safe. Connection information of a server address
+    /// is created exactly once, even if the address is accessed concurrently
+    /// for the first time, i.e. there is only one channel and one reflection
+    /// stream per server address.
     class ConnectionManager
     {
         public:
@@ -47,104 +129,93 @@ namespace cli
 
             /// To get the channel according to the server address. If the cached map doesn't contain the channel, create the connection list and update the map.
             /// @param f_serverAddress Service Addresses with Port, described in gRPC string format "hostname:port".
+            /// @param f_options tuning of the channel. Channels with different options are not shared.
             /// @returns the channel of the corresponding server address.
-            std::shared_ptr<grpc::Channel> getChannel(std::string f_serverAddress)
+            std::shared_ptr<grpc::Channel> getChannel(const std::string & f_serverAddress, const ChannelOptions & f_options = ChannelOptions())
             {
-                if(!findChannelByAddress(f_serverAddress))
-                {
-                    registerConnection(f_serverAddress);
-                }
-                return connections[f_serverAddress].channel;
+                return getConnection(f_serverAddress, f_options).channel;
             }
 
             /// To get the gRpc DescriptorDatabase according to the server address. If the cached map doesn't contain the channel, create the connection list and update the map.
             /// @param f_serverAddress Service Addresses with Port, described in gRPC string format "hostname:port".
+            /// @param f_options tuning of the channel used for reflection.
             /// @returns the gRpc DescriptorDatabase of the corresponding server address.
-            std::shared_ptr<grpc::ProtoReflectionDescriptorDatabase> getDescDb(std::string f_serverAddress)
+            std::shared_ptr<grpc::ProtoReflectionDescriptorDatabase> getDescDb(const std::string & f_serverAddress, const ChannelOptions & f_options = ChannelOptions())
             {
-                if(!findDescDbByAddress(f_serverAddress))
-                {
-                    if(connections[f_serverAddress].channel)
-                    {
-                        connections[f_serverAddress].descDb = std::make_shared<grpc::ProtoReflectionDescriptorDatabase>(connections[f_serverAddress].channel);
-                        connections[f_serverAddress].descPool = std::make_shared<grpc::protobuf::DescriptorPool>(connections[f_serverAddress].descDb.get());
-                    }
-                    else
-                    {
-                        registerConnection(f_serverAddress);
-                    }
-                }
-                return connections[f_serverAddress].descDb;
+                return getConnection(f_serverAddress, f_options).descDb;
             }
+
             /// To get the gRpc DescriptorPool according to the server address. If the cached map doesn't contain the channel, create the connection list and update the map.
             /// @param f_serverAddress Service Addresses with Port, described in gRPC string format "hostname:port".
+            /// @param f_options tuning of the channel used for reflection.
             /// @returns the gRpc DescriptorPool of the corresponding server address.
-            std::shared_ptr<grpc::protobuf::DescriptorPool> getDescPool(std::string f_serverAddress)
+            std::shared_ptr<grpc::protobuf::DescriptorPool> getDescPool(const std::string & f_serverAddress, const ChannelOptions & f_options = ChannelOptions())
             {
-
-                if(!findDescPoolByAddress(f_serverAddress))
-                {
-                    if(connections[f_serverAddress].channel)
-                    {
-                        connections[f_serverAddress].descDb = std::make_shared<grpc::ProtoReflectionDescriptorDatabase>(connections[f_serverAddress].channel);
-                        connections[f_serverAddress].descPool = std::make_shared<grpc::protobuf::DescriptorPool>(connections[f_serverAddress].descDb.get());
-                    }
-                    else
-                    {
-                        registerConnection(f_serverAddress);
-                    }
-                }
-                return connections[f_serverAddress].descPool;
+                return getConnection(f_serverAddress, f_options).descPool;
             }
+
+            /// To get all connection information of a server address with a single lookup.
+            /// If the cached map doesn't contain the server address, the connection list is created.
+            /// @param f_serverAddress Service Addresses with Port, described in gRPC string format "hostname:port".
+            /// @param f_options tuning of the channel. Connection information is cached per address and options.
+            /// @returns the connection list of the corresponding server address.
+            const ConnList & getConnection(const std::string & f_serverAddress, const ChannelOptions & f_options = ChannelOptions());
+
+            /// To get a channel from the channel pool of a server address for performing a call.
+            /// Each channel of the pool has its own connection (distinct channel arguments
+            /// prevent gRPC from sharing subchannels), so calls handed out to different
+            /// channels do not share one max-concurrent-streams limit.
+            /// The first channel of the pool is the one returned by getChannel().
+            /// Reflection (DescriptorDatabase and DescriptorPool) is shared by all channels.
+            /// @param f_serverAddress Service Addresses with Port, described in gRPC string format "hostname:port".
+            /// @param f_poolSize number of channels to distribute calls to. The pool is grown if required.
+            /// @param f_selection strategy to select the channel
+            /// @param f_options tuning of all channels of the pool
+            /// @returns a lease of the selected channel, keep it until the call is finished.
+            ChannelLease acquireChannel(const std::string & f_serverAddress, size_t f_poolSize, ChannelSelection f_selection, const ChannelOptions & f_options = ChannelOptions());
+
+            /// Connects to a list of servers in parallel and fetches their
+            /// service lists via reflection, so later calls to these servers
+            /// do not need to wait for connection establishment.
+            /// @param f_serverAddresses Service Addresses with Port, described in gRPC string format "hostname:port".
+            /// @param f_timeoutMs maximum time to wait for each connection to be established.
+            /// @param f_options tuning of the channels
+            /// @returns for each server address if connecting and fetching the service list succeeded.
+            std::vector<bool> prewarm(const std::vector<std::string> & f_serverAddresses, uint32_t f_timeoutMs, const ChannelOptions & f_options = ChannelOptions());
+
         private:
-            // Cached map of the gRpc connection information for resuing the channel, descriptor Database and DatabasePool
-            std::unordered_map<std::string, ConnList> connections;
-            // Check if the cached map contains the channel of the given server address or not.
-            bool findChannelByAddress(std::string f_serverAddress)
-            {
-                if(connections.find(f_serverAddress) != connections.end())
-                {
-                    if(connections[f_serverAddress].channel != nullptr)
-                    {
-                        return true;
-                    }
-                }
-                return false;
-            }
-            // Check if the cached map contains the gRpc DescriptorDatabase of given the server address or not.
-            bool findDescDbByAddress(std::string f_serverAddress)
+            /// Connection information of one server address, created once.
+            struct Entry
             {
-                if(connections.find(f_serverAddress) != connections.end())
-                {
-                    if(connections[f_serverAddress].descDb != nullptr)
-                    {
-                        return true;
-                    }
-                }
-                return false;
-            }
-            // Check if the cached map contains the gRpc DescriptorPool of the given server address or not.
-            bool findDescPoolByAddress(std::string f_serverAddress)
+                std::once_flag initFlag;
+                ConnList connList;
+
+                /// protects channelPool and nextPoolIndex
+                std::mutex poolMutex;
+                std::vector<std::shared_ptr<grpc::Channel>> channelPool;
+                std::vector<std::shared_ptr<std::atomic<uint32_t>>> outstandingCalls;
+                size_t nextPoolIndex = 0;
+            };
+
+            /// Part of the cached map. Server addresses (together with channel options) are distributed over
+            /// several shards to reduce lock contention.
+            struct Shard
             {
-                if(connections.find(f_serverAddress) != connections.end())
-                {
-                    if(connections[f_serverAddress].descPool != nullptr)
-                    {
-                        return true;
-                    }
-                }
-                return false;
-            }
+                std::mutex mutex;
+                std::unordered_map<std::string, std::shared_ptr<Entry>> entries;
+            };
+            static const size_t s_numShards = 16;
+
             /// To register the gRpc connection information of a given server address.
-            /// Connection List contains: Channel, DescriptorDatabase and DescriptorPool as value.
-            /// @param f_serverAddress Service Addresses with Port, described in gRPC string format "hostname:port" as key of the cached map.
-            void registerConnection(std::string f_serverAddress)
-            {
-                ConnList connection;
-                connection.channel = grpc::CreateChannel(f_serverAddress, grpc::InsecureChannelCredentials());
-                connection.descDb = std::make_shared<grpc::ProtoReflectionDescriptorDatabase>(connection.channel);
-                connection.descPool = std::make_shared<grpc::protobuf::DescriptorPool>(connection.descDb.get());
-                connections[f_serverAddress] = connection;
-            }
+            /// Connection List contains: Channel, DescriptorDatabase and DescriptorPool.
+            /// @param f_serverAddress Service Addresses with Port, described in gRPC string format "hostname:port".
+            /// @param f_options tuning of the channel
+            static void registerConnection(const std::string & f_serverAddress, const ChannelOptions & f_options, ConnList & f_out_connection);
+
+            /// @returns the (initialized) entry of a server address and channel options, creates it if required.
+            std::shared_ptr<Entry> getEntry(const std::string & f_serverAddress, const ChannelOptions & f_options);
+
+            // Cached map of the gRpc connection information for resuing the channel, descriptor Database and DatabasePool
+            std::array<Shard, s_numShards> m_shards;
     };
 }
@@ -0,0 +1,483 @@
+// Copyright 2019 IBM Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <libCli/FanOutCall.hpp>
+#include <libCli/AsyncCallEngine.hpp>
+#include <libCli/Call.hpp>
+#include <libCli/ConnectionManager.hpp>
+#include <libCli/GrammarConstruction.hpp>
+#include <libCli/MessageParsing.hpp>
+#include <libCli/OutputFormatting.hpp>
+#include <libCli/SigintCancellation.hpp>
+#include <libCli/Tracing.hpp>
+#include <libCli/cliUtils.hpp>
+#include <third_party/gRPC_utils/proto_reflection_descriptor_database.h>
+
+#include <google/protobuf/dynamic_message.h>
+#include <grpcpp/generic/generic_stub.h>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+using namespace ArgParse;
+using grpc::reflection::v1alpha::ServerReflection;
+using grpc::reflection::v1alpha::ServerReflectionRequest;
+using grpc::reflection::v1alpha::ServerReflectionResponse;
+
+namespace cli
+{
+
+namespace
+{
+    const char * const s_reflectionMethod = "/grpc.reflection.v1alpha.ServerReflection/ServerReflectionInfo";
+    const size_t s_defaultConcurrency = 50;
+
+    /// State of the call to one server. Verification of the service definition
+    /// and the RPC itself are asynchronous calls driven by an AsyncCallEngine.
+    /// The HostCall is used as tag for the verification stream.
+    struct HostCall : public AsyncCallEngine::Tag
+    {
+        enum class State
+        {
+            VerifyStart,
+            VerifyWrite,
+            VerifyRead,
+            VerifyWritesDone,
+            VerifyFinish,
+            Call
+        };
+
+        /// advances the state after an event, returns true if the server is done
+        typedef std::function<bool(HostCall & f_hostCall, bool f_ok)> EventHandler;
+        /// called once the server is done, may destroy the HostCall
+        typedef std::function<void(size_t f_index)> DoneHandler;
+
+        void proceed(bool f_ok) override
+        {
+            if((*handleEvent)(*this, f_ok))
+            {
+                // must be the last access, as the HostCall is destroyed afterwards:
+                (*handleDone)(index);
+            }
+        }
+
+        const EventHandler * handleEvent;
+        const DoneHandler * handleDone;
+        /// queue of the verification stream
+        grpc::CompletionQueue * cq;
+        size_t index;
+        std::string serverUri;
+        std::shared_ptr<grpc::Channel> channel;
+        std::unique_ptr<grpc::GenericStub> stub;
+        State state;
+
+        // service definition verification via reflection (on a channel with default tuning):
+        std::unique_ptr<grpc::GenericStub> reflectionStub;
+        grpc::ClientContext reflectionContext;
+        std::unique_ptr<grpc::GenericClientAsyncReaderWriter> reflectionStream;
+        grpc::ByteBuffer reflectionResponse;
+        bool reflectionResponseReceived = false;
+        grpc::Status reflectionStatus;
+
+        // the RPC:
+        std::chrono::steady_clock::time_point callStartTime;
+        grpc::ClientContext callContext;
+    };
+
+    grpc::ByteBuffer toByteBuffer(const std::string & f_data)
+    {
+        grpc::Slice slice(f_data);
+        return grpc::ByteBuffer(&slice, 1);
+    }
+
+    std::string toString(const grpc::ByteBuffer & f_buffer)
+    {
+        std::vector<grpc::Slice> slices;
+        std::string result;
+        if(f_buffer.Dump(&slices).ok())
+        {
+            for(const grpc::Slice & slice : slices)
+            {
+                result.append(reinterpret_cast<const char*>(slice.begin()), slice.size());
+            }
+        }
+        return result;
+    }
+
+    std::string getStatusString(const grpc::Status & f_status)
+    {
+        return "Status code: " + std::to_string(f_status.error_code()) + " " + getGrpcStatusCodeAsString(f_status.error_code()) + ", error message: " + f_status.error_message();
+    }
+
+    std::string getMillisecondsString(std::chrono::steady_clock::duration f_duration)
+    {
+        std::ostringstream result;
+        result << std::fixed << std::setprecision(2) << std::chrono::duration<double, std::milli>(f_duration).count();
+        return result.str();
+    }
+
+    /// Extracts the file descriptor of the file defining the requested symbol from a reflection response.
+    /// @returns false if the response does not contain it
+    bool getFileDescriptor(const std::string & f_serializedResponse, std::string & f_out_fileDescriptor)
+    {
+        ServerReflectionResponse response;
+        if((not response.ParseFromString(f_serializedResponse)) or
+                (not response.has_file_descriptor_response()) or
+                (response.file_descriptor_response().file_descriptor_proto_size() == 0))
+        {
+            return false;
+        }
+        // the first file is the one containing the symbol, followed by its dependencies:
+        f_out_fileDescriptor = response.file_descriptor_response().file_descriptor_proto(0);
+        return true;
+    }
+
+    /// Fetches the serialized file descriptor of the file defining a service via reflection.
+    grpc::Status fetchServiceFileDescriptor(std::shared_ptr<grpc::Channel> f_channel, const std::string & f_serviceName, uint32_t f_timeoutMs, std::string & f_out_fileDescriptor)
+    {
+        TraceSpan span("reflection::FileContainingSymbol", "reflection");
+        std::unique_ptr<ServerReflection::Stub> stub = ServerReflection::NewStub(f_channel);
+        grpc::ClientContext context;
+        context.set_deadline(std::chrono::system_clock::now() + std::chrono::milliseconds(f_timeoutMs));
+        auto stream = stub->ServerReflectionInfo(&context);
+        ServerReflectionRequest request;
+        request.set_file_containing_symbol(f_serviceName);
+        ServerReflectionResponse response;
+        stream->Write(request);
+        stream->WritesDone();
+        bool received = stream->Read(&response);
+        grpc::Status status = stream->Finish();
+        if(status.ok() and not (received and getFileDescriptor(response.SerializeAsString(), f_out_fileDescriptor)))
+        {
+            return grpc::Status(grpc::StatusCode::NOT_FOUND, "Service '" + f_serviceName + "' not found via reflection");
+        }
+        return status;
+    }
+}
+
+int fanOutCall(ParsedElement & f_parseTree)
+{
+    TraceSpan fanOutSpan("fanOutCall", "rpc");
+    std::string serviceName = f_parseTree.findFirstChild("Service");
+    std::string methodName = f_parseTree.findFirstChild("Method");
+    uint32_t connectTimeoutMs = getConnectTimeoutMs(&f_parseTree);
+    ChannelOptions channelOptions = getChannelOptions(&f_parseTree);
+    grpc_compression_algorithm callCompression;
+    bool haveCallCompression = getCallCompression(&f_parseTree, callCompression);
+    std::vector<std::string> serverUris = getServerUris(&f_parseTree);
+    if(serverUris.empty())
+    {
+        std::cerr << "Error: No server given in hosts file '" << f_parseTree.findFirstChild("HostsFile") << "'" << std::endl;
+        return -1;
+    }
+    std::string reflectionHost = getServerUri(&f_parseTree);
+    std::shared_ptr<grpc::Channel> reflectionChannel = ConnectionManager::getInstance().getChannel(reflectionHost);
+    if(not waitForChannelConnected(reflectionChannel, connectTimeoutMs))
+    {
+        std::cerr << "Error: channel connection attempt timed out for all servers" << std::endl;
+        return -1;
+    }
+
+    const grpc::protobuf::ServiceDescriptor* service = nullptr;
+    {
+        TraceSpan reflectionSpan("reflection::FindServiceByName", "reflection");
+        service = ConnectionManager::getInstance().getDescPool(reflectionHost)->FindServiceByName(serviceName);
+    }
+    if(service == nullptr)
+    {
+        std::cerr << "Error: Service '" << serviceName << "' not found" << std::endl;
+        return -1;
+    }
+    auto method = service->FindMethodByName(methodName);
+    if(method == nullptr)
+    {
+        std::cerr << "Error: Method not found" << std::endl;
+        return -1;
+    }
+    if(method->client_streaming() or method->server_streaming())
+    {
+        std::cerr << "Error: Calling multiple servers is only supported for unary RPCs" << std::endl;
+        return -1;
+    }
+
+    // reference for verifying the service definition of all other servers:
+    std::string referenceFileDescriptor;
+    grpc::Status referenceStatus = fetchServiceFileDescriptor(reflectionChannel, serviceName, connectTimeoutMs, referenceFileDescriptor);
+    if(not referenceStatus.ok())
+    {
+        std::cerr << "Error: Could not fetch definition of service '" << serviceName << "' from '" << reflectionHost << "' ;( " << getStatusString(referenceStatus) << std::endl;
+        return -1;
+    }
+    ServerReflectionRequest reflectionRequest;
+    reflectionRequest.set_file_containing_symbol(serviceName);
+    const grpc::ByteBuffer serializedReflectionRequest = toByteBuffer(reflectionRequest.SerializeAsString());
+
+    // the request is parsed and serialized only once and sent to all servers:
+    google::protobuf::DynamicMessageFactory dynamicFactory;
+    std::vector<ParsedElement*> requestMessages;
+    f_parseTree.findAllSubTrees("Message", requestMessages, true);
+    ParsedElement & requestParseTree = requestMessages.empty() ? f_parseTree : *requestMessages[0];
+    std::unique_ptr<grpc::protobuf::Message> message;
+    {
+        TraceSpan span("parseMessage", "rpc");
+        message = cli::parseMessage(requestParseTree, dynamicFactory, method->input_type());
+    }
+    if(not message)
+    {
+        std::cerr << "Error: Error parsing method arguments -> aborting the call :-(" << std::endl;
+        return -1;
+    }
+    if(f_parseTree.findFirstChild("PrintParsedMessage") != "")
+    {
+        cli::OutputFormatter imessageFormatter;
+        std::cout << "Request message:" << std::endl <<  imessageFormatter.messageToString(*message, method->input_type(), "| ", "| " ) << std::endl;
+    }
+    grpc::string serializedRequest;
+    if(not message->SerializeToString(&serializedRequest))
+    {
+        std::cerr << "Error: Failed to serialize method arguments" << std::endl;
+        return -1;
+    }
+    const grpc::ByteBuffer request = toByteBuffer(serializedRequest);
+    const std::string methodStr = "/" + serviceName + "/" + methodName;
+
+    cli::OutputFormatter messageFormatter;
+    configureOutputFormatter(f_parseTree, messageFormatter);
+    bool customOutputFormatRequested = false;
+    ParsedElement customFormatParseTree = f_parseTree.findFirstSubTree("CustomOutputFormat", customOutputFormatRequested);
+    if(customOutputFormatRequested)
+    {
+        // custom output is never colored:
+        messageFormatter.clearColorMap();
+    }
+    const grpc::protobuf::Message * replyPrototype = dynamicFactory.GetPrototype(method->output_type());
+
+    size_t maxConcurrentCalls = s_defaultConcurrency;
+    std::string concurrency = f_parseTree.findFirstChild("FanOutConcurrency");
+    if(concurrency != "")
+    {
+        maxConcurrentCalls = std::max<size_t>(std::stoul(concurrency), 1);
+    }
+
+    // the engine's poller threads handle all events, the main thread only starts
+    // new servers when others are done:
+    AsyncCallEngine engine(std::min<size_t>(maxConcurrentCalls, std::max<unsigned>(std::thread::hardware_concurrency(), 1)));
+    std::vector<std::unique_ptr<HostCall>> hostCalls(serverUris.size());
+    // guards hostCalls and finishedHosts:
+    std::mutex hostCallsMutex;
+    std::condition_variable hostFinished;
+    std::vector<size_t> finishedHosts;
+    // guards the output and numSucceeded:
+    std::mutex outputMutex;
+    size_t numSucceeded = 0;
+
+    const HostCall::DoneHandler handleDone = [&](size_t f_index)
+    {
+        std::lock_guard<std::mutex> lock(hostCallsMutex);
+        finishedHosts.push_back(f_index);
+        hostFinished.notify_one();
+    };
+
+    auto printReply = [&](HostCall & f_hostCall, const grpc::Status & f_status, grpc::ByteBuffer & f_reply)
+    {
+        std::string latency = getMillisecondsString(std::chrono::steady_clock::now() - f_hostCall.callStartTime);
+        std::unique_ptr<grpc::protobuf::Message> replyMessage;
+        if(f_status.ok())
+        {
+            replyMessage.reset(replyPrototype->New());
+            parseFromByteBuffer(f_reply, *replyMessage);
+        }
+        std::lock_guard<std::mutex> lock(outputMutex);
+        if(not f_status.ok())
+        {
+            std::cerr << getTimeString() << ": RPC to " << f_hostCall.serverUri << " failed after " << latency << " ms ;( " << getStatusString(f_status) << std::endl;
+            return;
+        }
+        numSucceeded++;
+        std::cerr << getTimeString() << ": Received message from " << f_hostCall.serverUri << " after " << latency << " ms:" << std::endl;
+        if(not customOutputFormatRequested)
+        {
+            std::cout << messageFormatter.messageToString(*replyMessage, method->output_type(), "| ", "| ") << std::endl;
+        }
+        else
+        {
+            std::cout << customMessageFormat(*replyMessage, method->output_type(), customFormatParseTree, messageFormatter);
+            std::cerr << std::endl;
+        }
+    };
+
+    auto startRpc = [&](HostCall & f_hostCall)
+    {
+        f_hostCall.state = HostCall::State::Call;
+        f_hostCall.callStartTime = std::chrono::steady_clock::now();
+        f_hostCall.callContext.set_deadline(getDeadline(&f_parseTree));
+        if(haveCallCompression)
+        {
+            f_hostCall.callContext.set_compression_algorithm(callCompression);
+        }
+        HostCall * hostCall = &f_hostCall;
+        engine.startUnaryCall(*f_hostCall.stub, f_hostCall.callContext, methodStr, request, [&printReply, &handleDone, hostCall](const grpc::Status & f_status, grpc::ByteBuffer & f_reply)
+        {
+            printReply(*hostCall, f_status, f_reply);
+            handleDone(hostCall->index);
+        });
+    };
+
+    // advances the state of a server's service definition verification.
+    // Events of one server are handled sequentially, as there is only one
+    // pending operation at a time.
+    // @returns true if the server is done
+    const HostCall::EventHandler handleEvent = [&](HostCall & f_hostCall, bool f_ok) -> bool
+    {
+        switch(f_hostCall.state)
+        {
+            case HostCall::State::VerifyStart:
+                if(f_ok)
+                {
+                    f_hostCall.state = HostCall::State::VerifyWrite;
+                    f_hostCall.reflectionStream->Write(serializedReflectionRequest, &f_hostCall);
+                    return false;
+                }
+                break;
+            case HostCall::State::VerifyWrite:
+                if(f_ok)
+                {
+                    f_hostCall.state = HostCall::State::VerifyRead;
+                    f_hostCall.reflectionStream->Read(&f_hostCall.reflectionResponse, &f_hostCall);
+                    return false;
+                }
+                break;
+            case HostCall::State::VerifyRead:
+                f_hostCall.reflectionResponseReceived = f_ok;
+                if(f_ok)
+                {
+                    f_hostCall.state = HostCall::State::VerifyWritesDone;
+                    f_hostCall.reflectionStream->WritesDone(&f_hostCall);
+                    return false;
+                }
+                break;
+            case HostCall::State::VerifyWritesDone:
+                break;
+            case HostCall::State::VerifyFinish:
+            {
+                std::string fileDescriptor;
+                std::lock_guard<std::mutex> lock(outputMutex);
+                if(not f_hostCall.reflectionStatus.ok())
+                {
+                    std::cerr << getTimeString() << ": Skipped " << f_hostCall.serverUri << ", verifying service definition failed ;( " << getStatusString(f_hostCall.reflectionStatus) << std::endl;
+                }
+                else if((not f_hostCall.reflectionResponseReceived) or (not getFileDescriptor(toString(f_hostCall.reflectionResponse), fileDescriptor)))
+                {
+                    std::cerr << getTimeString() << ": Skipped " << f_hostCall.serverUri << ", service '" << serviceName << "' not found via reflection" << std::endl;
+                }
+                else if(fileDescriptor != referenceFileDescriptor)
+                {
+                    std::cerr << getTimeString() << ": Skipped " << f_hostCall.serverUri << ", definition of service '" << serviceName << "' differs from the one of " << reflectionHost << std::endl;
+                }
+                else
+                {
+                    // the RPC completes via its own callback:
+                    startRpc(f_hostCall);
+                    return false;
+                }
+                return true;
+            }
+            case HostCall::State::Call:
+                // the RPC does not use the HostCall as tag
+                return false;
+        }
+        // the reflection stream failed or is complete, get its status:
+        f_hostCall.state = HostCall::State::VerifyFinish;
+        f_hostCall.reflectionStream->Finish(&f_hostCall.reflectionStatus, &f_hostCall);
+        return false;
+    };
+
+    auto startHost = [&](size_t f_index)
+    {
+        hostCalls[f_index].reset(new HostCall());
+        HostCall & hostCall = *hostCalls[f_index];
+        hostCall.handleEvent = &handleEvent;
+        hostCall.handleDone = &handleDone;
+        hostCall.index = f_index;
+        hostCall.serverUri = serverUris[f_index];
+        hostCall.channel = ConnectionManager::getInstance().getChannel(hostCall.serverUri, channelOptions);
+        hostCall.stub.reset(new grpc::GenericStub(hostCall.channel));
+        if(hostCall.serverUri == reflectionHost)
+        {
+            startRpc(hostCall);
+            return;
+        }
+        hostCall.state = HostCall::State::VerifyStart;
+        hostCall.cq = engine.getCompletionQueue();
+        hostCall.reflectionContext.set_deadline(std::chrono::system_clock::now() + std::chrono::milliseconds(connectTimeoutMs));
+        hostCall.reflectionStub.reset(new grpc::GenericStub(ConnectionManager::getInstance().getChannel(hostCall.serverUri)));
+        hostCall.reflectionStream = hostCall.reflectionStub->PrepareCall(&hostCall.reflectionContext, s_reflectionMethod, hostCall.cq);
+        hostCall.reflectionStream->StartCall(&hostCall);
+    };
+
+    // Ctrl+C cancels all running calls and no further servers are called:
+    SigintCancellation sigintCancellation([&]()
+    {
+        std::lock_guard<std::mutex> lock(hostCallsMutex);
+        for(std::unique_ptr<HostCall> & hostCall : hostCalls)
+        {
+            if(hostCall)
+            {
+                hostCall->reflectionContext.TryCancel();
+                hostCall->callContext.TryCancel();
+            }
+        }
+    });
+
+    size_t nextHost = 0;
+    size_t numRunning = 0;
+    {
+        std::unique_lock<std::mutex> lock(hostCallsMutex);
+        while(true)
+        {
+            for(size_t index : finishedHosts)
+            {
+                hostCalls[index].reset();
+                numRunning--;
+            }
+            finishedHosts.clear();
+            while((nextHost < serverUris.size()) and (numRunning < maxConcurrentCalls) and (not sigintCancellation.wasCancelled()))
+            {
+                startHost(nextHost++);
+                numRunning++;
+            }
+            if(numRunning == 0)
+            {
+                break;
+            }
+            hostFinished.wait(lock, [&]() { return not finishedHosts.empty(); });
+        }
+    }
+
+    if(sigintCancellation.wasCancelled())
+    {
+        std::cerr << "Cancelled by user (SIGINT), " << (serverUris.size() - nextHost) << " servers were not called." << std::endl;
+    }
+    std::cerr << "Called " << serverUris.size() << " servers: " << numSucceeded << " succeeded, " << (serverUris.size() - numSucceeded) << " failed." << std::endl;
+    return (numSucceeded == serverUris.size()) ? 0 : -1;
+}
+
+}
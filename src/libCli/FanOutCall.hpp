@@ -0,0 +1,30 @@
+// Copyright 2019 IBM Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <libArgParse/ArgParse.hpp>
+
+namespace cli
+{
+    /// Performs the unary RPC described by the parse tree on all servers given
+    /// as server list or hosts file, with a bounded number of concurrent calls.
+    /// Reflection is only used on one server (see selectReflectionHost()).
+    /// Before calling any other server, its definition of the service is compared
+    /// with the one of the reflection server via a single reflection request.
+    /// Results are printed as they complete, together with the latency of each call.
+    /// @param f_parseTree Parse tree containing all relevant information for the call.
+    /// @returns 0 if the RPC succeeded on all servers, -1 otherwise
+    int fanOutCall(ArgParse::ParsedElement & f_parseTree);
+}
@@ -0,0 +1,173 @@
+// Copyright 2019 IBM Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <libCli/FieldProjection.hpp>
+#include <google/protobuf/wire_format.h>
+#include <google/protobuf/wire_format_lite.h>
+#include <grpcpp/support/proto_buffer_reader.h>
+
+using google::protobuf::internal::WireFormat;
+using google::protobuf::internal::WireFormatLite;
+
+namespace cli
+{
+
+FieldProjection::FieldProjection()
+{
+    m_root.field = nullptr;
+    m_root.complete = false;
+}
+
+bool FieldProjection::addFieldPath(const grpc::protobuf::Descriptor * f_messageDescriptor, const std::string & f_fieldPath, std::string & f_out_error)
+{
+    Node * node = &m_root;
+    const grpc::protobuf::Descriptor * messageDescriptor = f_messageDescriptor;
+    size_t nameStart = 0;
+    while(true)
+    {
+        size_t nameEnd = f_fieldPath.find('.', nameStart);
+        std::string fieldName = f_fieldPath.substr(nameStart, (nameEnd == std::string::npos) ? std::string::npos : nameEnd - nameStart);
+        bool isLastField = (nameEnd == std::string::npos);
+
+        if(messageDescriptor == nullptr)
+        {
+            f_out_error = "Field '" + node->field->name() + "' in '" + f_fieldPath + "' is not a message field";
+            return false;
+        }
+        const google::protobuf::FieldDescriptor * field = messageDescriptor->FindFieldByName(fieldName);
+        if(field == nullptr)
+        {
+            f_out_error = "No field '" + fieldName + "' in message type '" + messageDescriptor->full_name() + "'";
+            return false;
+        }
+        if((not isLastField) and field->is_map())
+        {
+            f_out_error = "Field '" + fieldName + "' in '" + f_fieldPath + "' is a map, only complete maps can be selected";
+            return false;
+        }
+
+        if(node->complete)
+        {
+            // a parent field is already selected completely
+            return true;
+        }
+
+        std::shared_ptr<Node> & child = node->children[field->number()];
+        if(not child)
+        {
+            child = std::make_shared<Node>();
+            child->field = field;
+            child->complete = false;
+        }
+        node = child.get();
+
+        if(isLastField)
+        {
+            node->complete = true;
+            node->children.clear();
+            return true;
+        }
+
+        messageDescriptor = (field->type() == grpc::protobuf::FieldDescriptor::Type::TYPE_MESSAGE) ? field->message_type() : nullptr;
+        nameStart = nameEnd + 1;
+    }
+}
+
+bool FieldProjection::empty() const
+{
+    return m_root.children.empty();
+}
+
+bool FieldProjection::parseFromByteBuffer(const grpc::ByteBuffer & f_serializedMessage, grpc::protobuf::Message * f_message) const
+{
+    // the reader needs a mutable buffer, the copy only references the slices:
+    grpc::ByteBuffer buffer(f_serializedMessage);
+    grpc::ProtoBufferReader reader(&buffer);
+    google::protobuf::io::CodedInputStream input(&reader);
+    return parseMessage(m_root, input, f_message) and input.ConsumedEntireMessage();
+}
+
+bool FieldProjection::parseMessage(const Node & f_node, google::protobuf::io::CodedInputStream & f_input, grpc::protobuf::Message * f_message)
+{
+    const google::protobuf::Reflection * reflection = f_message->GetReflection();
+    while(true)
+    {
+        uint32_t tag = f_input.ReadTag();
+        if(tag == 0)
+        {
+            // end of (sub-)message
+            return true;
+        }
+
+        auto childIt = f_node.children.find(WireFormatLite::GetTagFieldNumber(tag));
+        if(childIt == f_node.children.end())
+        {
+            // not selected: skip without materializing. Length delimited
+            // fields are skipped without copying their content.
+            if(not WireFormatLite::SkipField(&f_input, tag))
+            {
+                return false;
+            }
+            continue;
+        }
+
+        const Node & child = *childIt->second;
+        if(child.complete or (WireFormatLite::GetTagWireType(tag) != WireFormatLite::WIRETYPE_LENGTH_DELIMITED))
+        {
+            if(not WireFormat::ParseAndMergeField(tag, child.field, f_message, &f_input))
+            {
+                return false;
+            }
+            continue;
+        }
+
+        // partially selected sub-message:
+        uint32_t length;
+        if(not f_input.ReadVarint32(&length))
+        {
+            return false;
+        }
+        google::protobuf::io::CodedInputStream::Limit limit = f_input.PushLimit(length);
+        grpc::protobuf::Message * subMessage;
+        if(child.field->is_repeated())
+        {
+            subMessage = reflection->AddMessage(f_message, child.field);
+        }
+        else
+        {
+            subMessage = reflection->MutableMessage(f_message, child.field);
+        }
+        if((not parseMessage(child, f_input, subMessage)) or (not f_input.ConsumedEntireMessage()))
+        {
+            return false;
+        }
+        f_input.PopLimit(limit);
+    }
+}
+
+void FieldProjection::getFieldDescriptors(std::unordered_set<const google::protobuf::FieldDescriptor*> & f_out_fields) const
+{
+    collectFieldDescriptors(m_root, f_out_fields);
+}
+
+void FieldProjection::collectFieldDescriptors(const Node & f_node, std::unordered_set<const google::protobuf::FieldDescriptor*> & f_out_fields)
+{
+    for(const auto & child : f_node.children)
+    {
+        f_out_fields.insert(child.second->field);
+        collectFieldDescriptors(*child.second, f_out_fields);
+    }
+}
+
+}
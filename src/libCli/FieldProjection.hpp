@@ -0,0 +1,73 @@
+// Copyright 2019 IBM Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <third_party/gRPC_utils/proto_reflection_descriptor_database.h>
+#include <google/protobuf/io/coded_stream.h>
+#include <grpcpp/support/byte_buffer.h>
+
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_set>
+
+namespace cli
+{
+    /// A selection of (possibly nested) fields of a message type.
+    /// Used to decode only the selected fields of a serialized message. All
+    /// other fields are skipped on the wire without being copied or materialized.
+    class FieldProjection
+    {
+        public:
+            FieldProjection();
+
+            /// Adds a field path to the projection.
+            /// @param f_messageDescriptor message type the path is relative to
+            /// @param f_fieldPath field names separated by '.' (e.g. "payload.header.id").
+            ///        All fields but the last one need to be non-map message fields.
+            ///        The last field is decoded completely.
+            /// @param f_out_error set to a human readable description if the path is invalid
+            /// @returns false if the path is invalid
+            bool addFieldPath(const grpc::protobuf::Descriptor * f_messageDescriptor, const std::string & f_fieldPath, std::string & f_out_error);
+
+            /// @returns true if no field path was added
+            bool empty() const;
+
+            /// Decodes the selected fields of a serialized message.
+            /// The message is read directly from the slices of the buffer, without copying it.
+            /// @param f_serializedMessage message in protobuf wire format
+            /// @param f_message message to merge the selected fields into
+            /// @returns false if the wire data is malformed
+            bool parseFromByteBuffer(const grpc::ByteBuffer & f_serializedMessage, grpc::protobuf::Message * f_message) const;
+
+            /// Collects the descriptors of all fields on any of the projected paths.
+            void getFieldDescriptors(std::unordered_set<const google::protobuf::FieldDescriptor*> & f_out_fields) const;
+
+        private:
+            struct Node
+            {
+                const google::protobuf::FieldDescriptor * field;
+                /// true if the field is decoded completely (last field of a path)
+                bool complete;
+                /// selected sub-fields, keyed by field number
+                std::map<int, std::shared_ptr<Node>> children;
+            };
+
+            static bool parseMessage(const Node & f_node, google::protobuf::io::CodedInputStream & f_input, grpc::protobuf::Message * f_message);
+            static void collectFieldDescriptors(const Node & f_node, std::unordered_set<const google::protobuf::FieldDescriptor*> & f_out_fields);
+
+            Node m_root;
+    };
+}
@@ -0,0 +1,132 @@
+// Copyright 2019 IBM Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <libCli/FormattingPipeline.hpp>
+
+namespace cli
+{
+
+FormattingPipeline::FormattingPipeline(size_t f_numWorkers, size_t f_maxMessagesInFlight, FormatFunction f_format, WriteFunction f_write) :
+    m_format(f_format),
+    m_write(f_write),
+    m_maxMessagesInFlight((f_maxMessagesInFlight > 0) ? f_maxMessagesInFlight : 1),
+    m_nextSequenceNumber(0),
+    m_nextSequenceNumberToWrite(0),
+    m_finishing(false)
+{
+    if(f_numWorkers == 0)
+    {
+        f_numWorkers = 1;
+    }
+    for(size_t i = 0; i < f_numWorkers; i++)
+    {
+        m_workers.push_back(std::thread(&FormattingPipeline::workerLoop, this, i));
+    }
+    m_writer = std::thread(&FormattingPipeline::writerLoop, this);
+}
+
+FormattingPipeline::~FormattingPipeline()
+{
+    finish();
+}
+
+void FormattingPipeline::push(grpc::ByteBuffer f_serializedMessage, std::string f_receiveInfo)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_spaceAvailable.wait(lock, [this]{ return (m_nextSequenceNumber - m_nextSequenceNumberToWrite) < m_maxMessagesInFlight; });
+
+    Job job;
+    job.sequenceNumber = m_nextSequenceNumber++;
+    job.serializedMessage.Swap(&f_serializedMessage);
+    job.receiveInfo.swap(f_receiveInfo);
+    m_jobs.push_back(std::move(job));
+    m_jobAvailable.notify_one();
+}
+
+void FormattingPipeline::finish()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if(m_finishing)
+        {
+            return;
+        }
+        m_finishing = true;
+    }
+    m_jobAvailable.notify_all();
+    m_resultAvailable.notify_all();
+
+    for(std::thread & worker : m_workers)
+    {
+        worker.join();
+    }
+    m_writer.join();
+}
+
+void FormattingPipeline::workerLoop(size_t f_workerIndex)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while(true)
+    {
+        m_jobAvailable.wait(lock, [this]{ return m_finishing or not m_jobs.empty(); });
+        if(m_jobs.empty())
+        {
+            // finishing and nothing left to do
+            return;
+        }
+        Job job = std::move(m_jobs.front());
+        m_jobs.pop_front();
+
+        lock.unlock();
+        Result result;
+        result.formattedMessage = m_format(job.serializedMessage, f_workerIndex);
+        result.receiveInfo.swap(job.receiveInfo);
+        lock.lock();
+
+        m_results[job.sequenceNumber] = std::move(result);
+        if(job.sequenceNumber == m_nextSequenceNumberToWrite)
+        {
+            m_resultAvailable.notify_one();
+        }
+    }
+}
+
+void FormattingPipeline::writerLoop()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while(true)
+    {
+        m_resultAvailable.wait(lock, [this]{
+                return (m_results.count(m_nextSequenceNumberToWrite) != 0) or
+                    (m_finishing and (m_nextSequenceNumberToWrite == m_nextSequenceNumber));
+            });
+        auto resultIt = m_results.find(m_nextSequenceNumberToWrite);
+        if(resultIt == m_results.end())
+        {
+            // finishing and everything is written
+            return;
+        }
+        Result result = std::move(resultIt->second);
+        m_results.erase(resultIt);
+
+        lock.unlock();
+        m_write(result.receiveInfo, result.formattedMessage);
+        lock.lock();
+
+        m_nextSequenceNumberToWrite++;
+        m_spaceAvailable.notify_one();
+    }
+}
+
+}
@@ -0,0 +1,108 @@
+// Copyright 2019 IBM Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <grpcpp/support/byte_buffer.h>
+
+#include <string>
+#include <deque>
+#include <map>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+namespace cli
+{
+    /// Formats reply messages on a pool of worker threads, while writing the
+    /// results in the same order as the messages were pushed.
+    ///
+    /// The reader pushes serialized messages as received (the slices are not
+    /// copied), each worker converts a message
+    /// into text via the format function and a single writer thread passes the
+    /// texts to the write function in push order.
+    /// The number of messages which are pushed but not yet written is bounded,
+    /// so push() blocks if the output is slower than the input.
+    class FormattingPipeline
+    {
+        public:
+            /// Converts one serialized message into the text to be written.
+            /// @param f_serializedMessage message as received from the stream
+            /// @param f_workerIndex index of the calling worker (0 <= index < number of workers).
+            ///        May be used to access per-worker state without locking.
+            typedef std::function<std::string(const grpc::ByteBuffer & f_serializedMessage, size_t f_workerIndex)> FormatFunction;
+
+            /// Writes one formatted message. Always called from the same thread
+            /// and in the order in which messages were pushed.
+            /// @param f_receiveInfo info text given to push() for this message
+            /// @param f_formattedMessage result of the format function
+            typedef std::function<void(const std::string & f_receiveInfo, const std::string & f_formattedMessage)> WriteFunction;
+
+            /// Starts the worker and writer threads.
+            /// @param f_numWorkers number of formatting threads (at least 1 is used)
+            /// @param f_maxMessagesInFlight maximum number of pushed but not yet written messages (at least 1 is used)
+            FormattingPipeline(size_t f_numWorkers, size_t f_maxMessagesInFlight, FormatFunction f_format, WriteFunction f_write);
+
+            /// Finishes the pipeline (see finish()).
+            ~FormattingPipeline();
+
+            /// Queues a message for formatting. Blocks while the maximum number of
+            /// messages in flight is reached.
+            /// @param f_serializedMessage the message to format
+            /// @param f_receiveInfo arbitrary text passed on to the write function together with the formatted message
+            void push(grpc::ByteBuffer f_serializedMessage, std::string f_receiveInfo);
+
+            /// Waits until all pushed messages are written and stops all threads.
+            /// No messages may be pushed afterwards.
+            void finish();
+
+        private:
+            struct Job
+            {
+                size_t sequenceNumber;
+                grpc::ByteBuffer serializedMessage;
+                std::string receiveInfo;
+            };
+
+            struct Result
+            {
+                std::string receiveInfo;
+                std::string formattedMessage;
+            };
+
+            void workerLoop(size_t f_workerIndex);
+            void writerLoop();
+
+            FormatFunction m_format;
+            WriteFunction m_write;
+            size_t m_maxMessagesInFlight;
+
+            std::mutex m_mutex;
+            std::condition_variable m_jobAvailable;
+            std::condition_variable m_resultAvailable;
+            std::condition_variable m_spaceAvailable;
+
+            std::deque<Job> m_jobs;
+            /// Formatted messages waiting for their predecessors to be written.
+            std::map<size_t, Result> m_results;
+            size_t m_nextSequenceNumber;
+            size_t m_nextSequenceNumberToWrite;
+            bool m_finishing;
+
+            std::vector<std::thread> m_workers;
+            std::thread m_writer;
+    };
+}
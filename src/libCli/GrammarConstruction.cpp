@@ -16,22 +16,140 @@
 #include <third_party/gRPC_utils/proto_reflection_descriptor_database.h>
 #include <libCli/cliUtils.hpp>
 #include <libCli/ConnectionManager.hpp>
+#include <libCli/Tracing.hpp>
 #include "protoDoc/protoDoc.pb.h"
 
+#include <chrono>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <unordered_set>
+
 using namespace ArgParse;
 
 namespace cli
 {
 
+/// Adds the default port to a server URI read from a hosts file, if it does not contain a port.
+static std::string addDefaultPort(const std::string & f_serverUri)
+{
+    if((f_serverUri.compare(0, 5, "unix:") == 0) or (f_serverUri.compare(0, 14, "unix-abstract:") == 0))
+    {
+        return f_serverUri;
+    }
+    size_t portSeparator = f_serverUri.find_last_of(':');
+    if((portSeparator != std::string::npos) and (portSeparator + 1 < f_serverUri.size()) and
+            (f_serverUri.find_first_not_of("0123456789", portSeparator + 1) == std::string::npos))
+    {
+        return f_serverUri;
+    }
+    return f_serverUri + ":50051";
+}
+
+/// Reads server URIs from a hosts file (one URI per line, empty lines and lines starting with '#' are ignored).
+static void readHostsFile(const std::string & f_fileName, std::vector<std::string> & f_out_serverUris)
+{
+    std::ifstream hostsFile(f_fileName);
+    std::string line;
+    while(std::getline(hostsFile, line))
+    {
+        size_t begin = line.find_first_not_of(" \t\r");
+        if((begin == std::string::npos) or (line[begin] == '#'))
+        {
+            continue;
+        }
+        size_t end = line.find_last_not_of(" \t\r");
+        f_out_serverUris.push_back(addDefaultPort(line.substr(begin, end - begin + 1)));
+    }
+}
+
+std::vector<std::string> getServerUris(ParsedElement * f_parseTree)
+{
+    std::vector<std::string> serverUris;
+    std::string hostsFile = f_parseTree->findFirstChild("HostsFile");
+    if(hostsFile != "")
+    {
+        readHostsFile(hostsFile, serverUris);
+    }
+    else
+    {
+        std::vector<ParsedElement *> serverUriTrees;
+        f_parseTree->findAllSubTrees("ServerUri", serverUriTrees, true);
+        for(ParsedElement * serverUriTree : serverUriTrees)
+        {
+            std::string serverUri = serverUriTree->getMatchedString();
+            if(serverUriTree->findFirstChild("TcpUri") != "" and serverUriTree->findFirstChild("TcpPort") == "")
+            {
+                serverUri += ":50051";
+            }
+            serverUris.push_back(serverUri);
+        }
+    }
+
+    // calling a server twice is not intended, remove duplicates but keep the order:
+    std::unordered_set<std::string> seen;
+    std::vector<std::string> result;
+    for(const std::string & serverUri : serverUris)
+    {
+        if(seen.insert(serverUri).second)
+        {
+            result.push_back(serverUri);
+        }
+    }
+    return result;
+}
+
+std::string selectReflectionHost(const std::vector<std::string> & f_serverUris, uint32_t f_connectTimeoutMs)
+{
+    if(f_serverUris.size() <= 1)
+    {
+        return f_serverUris.empty() ? "" : f_serverUris[0];
+    }
+
+    // grammar injectors and the call ask for the same host list several
+    // times, only select once:
+    static std::mutex cacheMutex;
+    static std::map<std::vector<std::string>, std::string> cache;
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    auto cached = cache.find(f_serverUris);
+    if(cached != cache.end())
+    {
+        return cached->second;
+    }
+
+    TraceSpan span("selectReflectionHost", "connection");
+    // connect to all servers in parallel, then take the first connected one
+    // in list order. All servers share one connect timeout:
+    std::vector<std::shared_ptr<grpc::Channel>> channels;
+    for(const std::string & serverUri : f_serverUris)
+    {
+        channels.push_back(ConnectionManager::getInstance().getChannel(serverUri));
+        channels.back()->GetState(true);
+    }
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(f_connectTimeoutMs);
+    std::string result = f_serverUris[0];
+    for(size_t i = 0; i < channels.size(); i++)
+    {
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        uint32_t remainingMs = (now < deadline) ? std::chrono::duration_cast<std::chrono::milliseconds>(deadline - now).count() : 0;
+        if((channels[i]->GetState(false) == GRPC_CHANNEL_READY) or waitForChannelConnected(channels[i], remainingMs))
+        {
+            result = f_serverUris[i];
+            break;
+        }
+    }
+    cache[f_serverUris] = result;
+    return result;
+}
+
 std::string getServerUri(ParsedElement * f_parseTree)
 {
-    std::string serverUri = f_parseTree->findFirstChild("ServerUri");
-    if(f_parseTree->findFirstChild("TcpUri") != "" and f_parseTree->findFirstChild("TcpPort") == "")
+    std::vector<std::string> serverUris = getServerUris(f_parseTree);
+    if(serverUris.size() > 1)
     {
-        serverUri += ":50051";
+        return selectReflectionHost(serverUris, getConnectTimeoutMs(f_parseTree));
     }
-    //serverUri = "127.0.0.1:50051";
-    return serverUri;
+    return serverUris.empty() ? "" : serverUris[0];
 }
 
 class GrammarInjectorMethodArgs : public GrammarInjector
@@ -49,6 +167,7 @@ class GrammarInjectorMethodArgs : public GrammarInjector
 
         virtual GrammarElement * getGrammar(ParsedElement * f_parseTree, std::string & f_ErrorMessage) override
         {
+            TraceSpan span("GrammarInjector::getGrammar(MethodArgs)", "grammar");
             // FIXME: we are already completing this without a service parsed.
             //  this works in most cases, as it will just fail. however this is not really a nice thing.
             std::string serviceName = f_parseTree->findFirstChild("Service");
@@ -65,7 +184,11 @@ class GrammarInjectorMethodArgs : public GrammarInjector
                 return nullptr;
             }
 
-            const grpc::protobuf::ServiceDescriptor* service = ConnectionManager::getInstance().getDescPool(serverAddress)->FindServiceByName(serviceName);
+            const grpc::protobuf::ServiceDescriptor* service = nullptr;
+            {
+                TraceSpan reflectionSpan("reflection::FindServiceByName", "reflection");
+                service = ConnectionManager::getInstance().getDescPool(serverAddress)->FindServiceByName(serviceName);
+            }
 
             if(service == nullptr)
             {
@@ -319,6 +442,7 @@ class GrammarInjectorMethods : public GrammarInjector
 
         virtual GrammarElement * getGrammar(ParsedElement * f_parseTree, std::string & f_ErrorMessage) override
         {
+            TraceSpan span("GrammarInjector::getGrammar(Method)", "grammar");
             // FIXME: we are already completing this without a service parsed.
             //  this works in most cases, as it will just fail. however this is not really a nice thing.
             std::string serviceName = f_parseTree->findFirstChild("Service");
@@ -333,7 +457,11 @@ class GrammarInjectorMethods : public GrammarInjector
                 return nullptr;
             }
 
-            const grpc::protobuf::ServiceDescriptor* service = ConnectionManager::getInstance().getDescPool(serverAddress)->FindServiceByName(serviceName);
+            const grpc::protobuf::ServiceDescriptor* service = nullptr;
+            {
+                TraceSpan reflectionSpan("reflection::FindServiceByName", "reflection");
+                service = ConnectionManager::getInstance().getDescPool(serverAddress)->FindServiceByName(serviceName);
+            }
             auto result = m_grammar.createElement<Alternation>();
             if(service != nullptr)
             {
@@ -373,6 +501,7 @@ class GrammarInjectorServices : public GrammarInjector
 
         virtual GrammarElement * getGrammar(ParsedElement * f_parseTree, std::string & f_ErrorMessage) override
         {
+            TraceSpan span("GrammarInjector::getGrammar(Service)", "grammar");
             std::string serverAddress = getServerUri(f_parseTree);
 
             //std::cout << "Injecting Service grammar for " << serverAddress << std::endl;
@@ -384,6 +513,7 @@ class GrammarInjectorServices : public GrammarInjector
                 return nullptr;
             }
 
+            TraceSpan reflectionSpan("reflection::ListServices", "reflection");
             std::vector<grpc::string> serviceList;
             if(not ConnectionManager::getInstance().getDescDb(serverAddress)->GetServices(&serviceList))
             {
@@ -408,6 +538,64 @@ class GrammarInjectorServices : public GrammarInjector
 
 };
 
+/// Constructs the grammar for a single server URI.
+static GrammarElement * constructServerUriGrammar(Grammar & f_grammarPool)
+{
+    // Server address
+    // We parse gRPC URIs roughly according to https://grpc.github.io/grpc/cpp/md_doc_naming.html
+    GrammarElement * serverUri = f_grammarPool.createElement<Alternation>("ServerUri");
+
+    // unix URIs:
+    GrammarElement * unixUri = f_grammarPool.createElement<Alternation>("UnixUri");
+
+    GrammarElement * unixUriSimple = f_grammarPool.createElement<Concatenation>();
+    unixUriSimple->addChild(f_grammarPool.createElement<FixedString>("unix:"));
+    unixUriSimple->addChild(f_grammarPool.createElement<RegEx>("[^ ,]+"));
+    unixUri->addChild(unixUriSimple);
+
+    GrammarElement * unixUriAbstract = f_grammarPool.createElement<Concatenation>();
+    unixUriAbstract->addChild(f_grammarPool.createElement<FixedString>("unix-abstract:"));
+    unixUriAbstract->addChild(f_grammarPool.createElement<RegEx>("[^ ,]+"));
+    unixUri->addChild(unixUriAbstract);
+
+    // TCP URIs:
+    GrammarElement * tcpUri = f_grammarPool.createElement<Concatenation>("TcpUri");
+    GrammarElement * tcpUriChoices = f_grammarPool.createElement<Alternation>("TcpUriChoices");
+
+    GrammarElement * dnsUri = f_grammarPool.createElement<Concatenation>();
+    GrammarElement * dnsIdentifier = f_grammarPool.createElement<Optional>();
+    dnsIdentifier->addChild(f_grammarPool.createElement<FixedString>("dns:"));
+    dnsUri->addChild(dnsIdentifier);
+    dnsUri->addChild(f_grammarPool.createElement<RegEx>("[^-:\\[\\],@ ][^:\\[\\], ]+", "Hostname"));
+    tcpUriChoices->addChild(dnsUri);
+
+    GrammarElement * ipv4Uri = f_grammarPool.createElement<Concatenation>();
+    ipv4Uri->addChild(f_grammarPool.createElement<FixedString>("ipv4:"));
+    ipv4Uri->addChild(f_grammarPool.createElement<RegEx>("\\d+\\.\\d+\\.\\d+\\.\\d+", "IPv4Address"));
+    tcpUriChoices->addChild(ipv4Uri);
+
+    GrammarElement * ipv6Uri = f_grammarPool.createElement<Concatenation>();
+    ipv6Uri->addChild(f_grammarPool.createElement<FixedString>("ipv6:"));
+    ipv6Uri->addChild(f_grammarPool.createElement<RegEx>("\\[?[0-9a-fA-F:]+\\]?", "IPv6Address"));
+    tcpUriChoices->addChild(ipv6Uri);
+
+    GrammarElement * serverPort = f_grammarPool.createElement<Optional>("OptionPort");
+    GrammarElement * cServerPort = f_grammarPool.createElement<Concatenation>();
+    cServerPort->addChild(f_grammarPool.createElement<FixedString>(":"));
+    cServerPort->addChild(f_grammarPool.createElement<RegEx>("\\d+", "TcpPort"));
+    serverPort->addChild(cServerPort);
+    tcpUri->addChild(tcpUriChoices);
+    tcpUri->addChild(serverPort);
+
+
+    // a server uri can either be a unix uri or a tcp uri.
+    // tcp uris can be dns, ipv4 or ipv6 uris all with optional port
+    serverUri->addChild(unixUri);
+    serverUri->addChild(tcpUri);
+
+    return serverUri;
+}
+
 GrammarElement * constructGrammar(Grammar & f_grammarPool)
 {
     // user defined output formatting
@@ -494,6 +682,10 @@ GrammarElement * constructGrammar(Grammar & f_grammarPool)
 
     //completeOption->addChild(f_grammarPool.createElement<FixedString>("--complete", "Complete"));
     optionsalt->addChild(f_grammarPool.createElement<FixedString>("--debugComplete", "CompleteDebug"));
+    GrammarElement * completeLimitOption = f_grammarPool.createElement<Concatenation>();
+    completeLimitOption->addChild(f_grammarPool.createElement<FixedString>("--completeLimit="));
+    completeLimitOption->addChild(f_grammarPool.createElement<RegEx>("[0-9]+", "CompleteLimit"));
+    optionsalt->addChild(completeLimitOption);
     optionsalt->addChild(f_grammarPool.createElement<FixedString>("--dot", "DotExport"));
     optionsalt->addChild(f_grammarPool.createElement<FixedString>("--noColor", "NoColor"));
     optionsalt->addChild(f_grammarPool.createElement<FixedString>("--color", "Color"));
@@ -504,6 +696,91 @@ GrammarElement * constructGrammar(Grammar & f_grammarPool)
     timeoutOption->addChild(f_grammarPool.createElement<FixedString>("--connectTimeoutMilliseconds="));
     timeoutOption->addChild(f_grammarPool.createElement<RegEx>("[0-9]+", "connectTimeout"));
     optionsalt->addChild(timeoutOption);
+    GrammarElement * hexdumpLimitOption = f_grammarPool.createElement<Concatenation>();
+    hexdumpLimitOption->addChild(f_grammarPool.createElement<FixedString>("--hexdumpLimit="));
+    hexdumpLimitOption->addChild(f_grammarPool.createElement<RegEx>("[0-9]+", "HexdumpLimit"));
+    optionsalt->addChild(hexdumpLimitOption);
+    GrammarElement * bytesToFileOption = f_grammarPool.createElement<Concatenation>();
+    bytesToFileOption->addChild(f_grammarPool.createElement<FixedString>("--bytesToFile="));
+    bytesToFileOption->addChild(f_grammarPool.createElement<RegEx>("[^: ]+", "BytesToFileField"));
+    bytesToFileOption->addChild(f_grammarPool.createElement<FixedString>(":"));
+    bytesToFileOption->addChild(f_grammarPool.createElement<RegEx>("[^ ]+", "BytesToFileName"));
+    optionsalt->addChild(bytesToFileOption);
+    GrammarElement * formatThreadsOption = f_grammarPool.createElement<Concatenation>();
+    formatThreadsOption->addChild(f_grammarPool.createElement<FixedString>("--formatThreads="));
+    formatThreadsOption->addChild(f_grammarPool.createElement<RegEx>("[0-9]+", "FormatThreads"));
+    optionsalt->addChild(formatThreadsOption);
+    GrammarElement * fieldsOption = f_grammarPool.createElement<Concatenation>();
+    fieldsOption->addChild(f_grammarPool.createElement<FixedString>("--fields="));
+    fieldsOption->addChild(f_grammarPool.createElement<RegEx>("[A-Za-z0-9_.,]+", "FieldProjection"));
+    optionsalt->addChild(fieldsOption);
+    GrammarElement * aggregateOption = f_grammarPool.createElement<Concatenation>();
+    aggregateOption->addChild(f_grammarPool.createElement<FixedString>("--aggregate="));
+    aggregateOption->addChild(f_grammarPool.createElement<RegEx>("[A-Za-z0-9_.,:]+", "Aggregate"));
+    optionsalt->addChild(aggregateOption);
+    GrammarElement * aggregateIntervalOption = f_grammarPool.createElement<Concatenation>();
+    aggregateIntervalOption->addChild(f_grammarPool.createElement<FixedString>("--aggregateIntervalMilliseconds="));
+    aggregateIntervalOption->addChild(f_grammarPool.createElement<RegEx>("[0-9]+", "AggregateInterval"));
+    optionsalt->addChild(aggregateIntervalOption);
+    GrammarElement * channelsOption = f_grammarPool.createElement<Concatenation>();
+    channelsOption->addChild(f_grammarPool.createElement<FixedString>("--channels="));
+    channelsOption->addChild(f_grammarPool.createElement<RegEx>("[0-9]+", "ChannelPoolSize"));
+    optionsalt->addChild(channelsOption);
+    GrammarElement * channelSelectionOption = f_grammarPool.createElement<Concatenation>();
+    channelSelectionOption->addChild(f_grammarPool.createElement<FixedString>("--channelSelection="));
+    GrammarElement * channelSelectionChoice = f_grammarPool.createElement<Alternation>("ChannelSelection");
+    channelSelectionChoice->addChild(f_grammarPool.createElement<FixedString>("roundRobin", "ChannelSelectionRoundRobin"));
+    channelSelectionChoice->addChild(f_grammarPool.createElement<FixedString>("leastOutstanding", "ChannelSelectionLeastOutstanding"));
+    channelSelectionOption->addChild(channelSelectionChoice);
+    optionsalt->addChild(channelSelectionOption);
+    GrammarElement * fanOutConcurrencyOption = f_grammarPool.createElement<Concatenation>();
+    fanOutConcurrencyOption->addChild(f_grammarPool.createElement<FixedString>("--fanOutConcurrency="));
+    fanOutConcurrencyOption->addChild(f_grammarPool.createElement<RegEx>("[0-9]+", "FanOutConcurrency"));
+    optionsalt->addChild(fanOutConcurrencyOption);
+    GrammarElement * deadlineOption = f_grammarPool.createElement<Concatenation>();
+    deadlineOption->addChild(f_grammarPool.createElement<FixedString>("--deadlineMilliseconds="));
+    deadlineOption->addChild(f_grammarPool.createElement<RegEx>("[0-9]+", "Deadline"));
+    optionsalt->addChild(deadlineOption);
+    GrammarElement * maxSendMessageSizeOption = f_grammarPool.createElement<Concatenation>();
+    maxSendMessageSizeOption->addChild(f_grammarPool.createElement<FixedString>("--maxSendMessageSize="));
+    maxSendMessageSizeOption->addChild(f_grammarPool.createElement<RegEx>("[0-9]+", "MaxSendMessageSize"));
+    optionsalt->addChild(maxSendMessageSizeOption);
+    GrammarElement * maxReceiveMessageSizeOption = f_grammarPool.createElement<Concatenation>();
+    maxReceiveMessageSizeOption->addChild(f_grammarPool.createElement<FixedString>("--maxReceiveMessageSize="));
+    maxReceiveMessageSizeOption->addChild(f_grammarPool.createElement<RegEx>("[0-9]+", "MaxReceiveMessageSize"));
+    optionsalt->addChild(maxReceiveMessageSizeOption);
+    GrammarElement * compressionOption = f_grammarPool.createElement<Concatenation>();
+    compressionOption->addChild(f_grammarPool.createElement<FixedString>("--compression="));
+    GrammarElement * compressionChoice = f_grammarPool.createElement<Alternation>("ChannelCompression");
+    compressionChoice->addChild(f_grammarPool.createElement<FixedString>("none"));
+    compressionChoice->addChild(f_grammarPool.createElement<FixedString>("deflate"));
+    compressionChoice->addChild(f_grammarPool.createElement<FixedString>("gzip"));
+    compressionOption->addChild(compressionChoice);
+    optionsalt->addChild(compressionOption);
+    GrammarElement * callCompressionOption = f_grammarPool.createElement<Concatenation>();
+    callCompressionOption->addChild(f_grammarPool.createElement<FixedString>("--callCompression="));
+    GrammarElement * callCompressionChoice = f_grammarPool.createElement<Alternation>("CallCompression");
+    callCompressionChoice->addChild(f_grammarPool.createElement<FixedString>("none"));
+    callCompressionChoice->addChild(f_grammarPool.createElement<FixedString>("deflate"));
+    callCompressionChoice->addChild(f_grammarPool.createElement<FixedString>("gzip"));
+    callCompressionOption->addChild(callCompressionChoice);
+    optionsalt->addChild(callCompressionOption);
+    GrammarElement * keepaliveTimeOption = f_grammarPool.createElement<Concatenation>();
+    keepaliveTimeOption->addChild(f_grammarPool.createElement<FixedString>("--keepaliveTimeMilliseconds="));
+    keepaliveTimeOption->addChild(f_grammarPool.createElement<RegEx>("[0-9]+", "KeepaliveTime"));
+    optionsalt->addChild(keepaliveTimeOption);
+    optionsalt->addChild(f_grammarPool.createElement<FixedString>("--noBdpProbe", "NoBdpProbe"));
+    GrammarElement * initialStreamWindowSizeOption = f_grammarPool.createElement<Concatenation>();
+    initialStreamWindowSizeOption->addChild(f_grammarPool.createElement<FixedString>("--initialStreamWindowSize="));
+    initialStreamWindowSizeOption->addChild(f_grammarPool.createElement<RegEx>("[0-9]+", "InitialStreamWindowSize"));
+    optionsalt->addChild(initialStreamWindowSizeOption);
+    optionsalt->addChild(f_grammarPool.createElement<FixedString>("--corkInitialMetadata", "CorkInitialMetadata"));
+    GrammarElement * traceOption = f_grammarPool.createElement<Concatenation>();
+    traceOption->addChild(f_grammarPool.createElement<FixedString>("--trace="));
+    traceOption->addChild(f_grammarPool.createElement<RegEx>("[^ ]+", "TraceFile"));
+    optionsalt->addChild(traceOption);
+    optionsalt->addChild(f_grammarPool.createElement<FixedString>("--timing", "Timing"));
+    optionsalt->addChild(f_grammarPool.createElement<FixedString>("--profileParser", "ProfileParser"));
     optionsalt->addChild(customOutputFormat);
     // FIXME FIXME FIXME: we cannot distinguish between --complete and --completeDebug.. this is a problem for arguments too, as we cannot guarantee, that we do not have an argument starting with the name of an other argument.
     // -> could solve by makeing FixedString greedy
@@ -518,58 +795,21 @@ GrammarElement * constructGrammar(Grammar & f_grammarPool)
     //        );
     options->addChild(optionsconcat);
 
-    // Server address
-    // We parse gRPC URIs roughly according to https://grpc.github.io/grpc/cpp/md_doc_naming.html
-    GrammarElement * serverUri = f_grammarPool.createElement<Alternation>("ServerUri");
-
-    // unix URIs:
-    GrammarElement * unixUri = f_grammarPool.createElement<Alternation>("UnixUri");
-
-    GrammarElement * unixUriSimple = f_grammarPool.createElement<Concatenation>();
-    unixUriSimple->addChild(f_grammarPool.createElement<FixedString>("unix:"));
-    unixUriSimple->addChild(f_grammarPool.createElement<RegEx>("[^ ]+"));
-    unixUri->addChild(unixUriSimple);
-
-    GrammarElement * unixUriAbstract = f_grammarPool.createElement<Concatenation>();
-    unixUriAbstract->addChild(f_grammarPool.createElement<FixedString>("unix-abstract:"));
-    unixUriAbstract->addChild(f_grammarPool.createElement<RegEx>("[^ ]+"));
-    unixUri->addChild(unixUriAbstract);
-
-    // TCP URIs:
-    GrammarElement * tcpUri = f_grammarPool.createElement<Concatenation>("TcpUri");
-    GrammarElement * tcpUriChoices = f_grammarPool.createElement<Alternation>("TcpUriChoices");
-
-    GrammarElement * dnsUri = f_grammarPool.createElement<Concatenation>();
-    GrammarElement * dnsIdentifier = f_grammarPool.createElement<Optional>();
-    dnsIdentifier->addChild(f_grammarPool.createElement<FixedString>("dns:"));
-    dnsUri->addChild(dnsIdentifier);
-    dnsUri->addChild(f_grammarPool.createElement<RegEx>("[^-:\\[\\] ][^:\\[\\] ]+", "Hostname"));
-    tcpUriChoices->addChild(dnsUri);
-
-    GrammarElement * ipv4Uri = f_grammarPool.createElement<Concatenation>();
-    ipv4Uri->addChild(f_grammarPool.createElement<FixedString>("ipv4:"));
-    ipv4Uri->addChild(f_grammarPool.createElement<RegEx>("\\d+\\.\\d+\\.\\d+\\.\\d+", "IPv4Address"));
-    tcpUriChoices->addChild(ipv4Uri);
-
-    GrammarElement * ipv6Uri = f_grammarPool.createElement<Concatenation>();
-    ipv6Uri->addChild(f_grammarPool.createElement<FixedString>("ipv6:"));
-    ipv6Uri->addChild(f_grammarPool.createElement<RegEx>("\\[?[0-9a-fA-F:]+\\]?", "IPv6Address"));
-    tcpUriChoices->addChild(ipv6Uri);
-
-    GrammarElement * serverPort = f_grammarPool.createElement<Optional>("OptionPort");
-    GrammarElement * cServerPort = f_grammarPool.createElement<Concatenation>();
-    cServerPort->addChild(f_grammarPool.createElement<FixedString>(":"));
-    cServerPort->addChild(f_grammarPool.createElement<RegEx>("\\d+", "TcpPort"));
-    serverPort->addChild(cServerPort);
-    tcpUri->addChild(tcpUriChoices);
-    tcpUri->addChild(serverPort);
-
-
-    // a server uri can either be a unix uri or a tcp uri.
-    // tcp uris can be dns, ipv4 or ipv6 uris all with optional port
-    serverUri->addChild(unixUri);
-    serverUri->addChild(tcpUri);
-
+    // Server addresses: a list of server URIs separated by ',' or a hosts file
+    GrammarElement * servers = f_grammarPool.createElement<Alternation>("Servers");
+    GrammarElement * serverList = f_grammarPool.createElement<Concatenation>("ServerList");
+    serverList->addChild(constructServerUriGrammar(f_grammarPool));
+    GrammarElement * moreServers = f_grammarPool.createElement<Repetition>();
+    GrammarElement * moreServersConcat = f_grammarPool.createElement<Concatenation>();
+    moreServersConcat->addChild(f_grammarPool.createElement<FixedString>(","));
+    moreServersConcat->addChild(constructServerUriGrammar(f_grammarPool));
+    moreServers->addChild(moreServersConcat);
+    serverList->addChild(moreServers);
+    servers->addChild(serverList);
+    GrammarElement * hostsFileOption = f_grammarPool.createElement<Concatenation>();
+    hostsFileOption->addChild(f_grammarPool.createElement<FixedString>("@"));
+    hostsFileOption->addChild(f_grammarPool.createElement<RegEx>("[^ ]+", "HostsFile"));
+    servers->addChild(hostsFileOption);
 
     //GrammarElement * testAlt = f_grammarPool.createElement<Alternation>("TestAlt");
     //testAlt->addChild(f_grammarPool.createElement<FixedString>("challo"));
@@ -578,7 +818,7 @@ GrammarElement * constructGrammar(Grammar & f_grammarPool)
     // main concat:
     GrammarElement * cmain = f_grammarPool.createElement<Concatenation>();
     cmain->addChild(options);
-    cmain->addChild(serverUri);
+    cmain->addChild(servers);
     //cmain->addChild(testAlt);
     //cmain->addChild(f_grammarPool.createElement<RegEx>(std::regex("\\S+"), "ServerAddress"));
     cmain->addChild(f_grammarPool.createElement<WhiteSpace>());
@@ -17,6 +17,9 @@
 #include <libArgParse/ArgParse.hpp>
 #include "libArgParse/ParsedElement.hpp"
 
+#include <string>
+#include <vector>
+
 namespace cli
 {
     /// Constructs the grammar for the gWhisper CLI.
@@ -24,5 +27,18 @@ namespace cli
     /// @returns the root element of the generated grammar. The pointer should not
     ///          be used after the given f_grammarPool is de-allocated.
     ArgParse::GrammarElement * constructGrammar(ArgParse::Grammar & f_grammarPool);
+
+    /// @returns all server URIs given in the parse tree (a list of URIs or a
+    ///          hosts file), default port added where none was given, without duplicates.
+    std::vector<std::string> getServerUris(ArgParse::ParsedElement * f_parseTree);
+
+    /// Selects the server used for reflection from a list of servers: the
+    /// first one (in list order) which connects within the connect timeout.
+    /// Connection attempts to all servers are made in parallel. The result is
+    /// cached for the given list.
+    /// @returns the selected server URI, the first one if no server connects.
+    std::string selectReflectionHost(const std::vector<std::string> & f_serverUris, uint32_t f_connectTimeoutMs);
+
+    /// @returns the server URI to use for reflection and single calls.
     std::string getServerUri(ArgParse::ParsedElement * f_parseTree);
 }
@@ -13,6 +13,23 @@
 // limitations under the License.
 
 #include <libCli/OutputFormatting.hpp>
+#include <algorithm>
+
+/// Lookup table holding the two lower case hex digits of every byte value.
+struct HexTable
+{
+    HexTable()
+    {
+        const char * digits = "0123456789abcdef";
+        for(size_t i = 0; i < 256; i++)
+        {
+            m_digits[i][0] = digits[i >> 4];
+            m_digits[i][1] = digits[i & 0xf];
+        }
+    }
+    char m_digits[256][2];
+};
+static const HexTable g_hexTable;
 
 namespace cli
 {
@@ -47,7 +64,8 @@ namespace cli
             {ColorClass::DecimalValue, "\e[39m"},
             {ColorClass::HexValue, "\e[39m"},
             {ColorClass::EnumValue, "\e[33m"},
-        }
+        },
+        m_hexdumpLimit(std::numeric_limits<size_t>::max())
     {
 
     }
@@ -55,6 +73,7 @@ namespace cli
     void OutputFormatter::clearColorMap()
     {
         m_colorMap.clear();
+        m_formatInfoCache.clear();
     }
 
     void OutputFormatter::disableSimpleMapOutput()
@@ -62,6 +81,30 @@ namespace cli
         m_isSimpleMapOutput = false;
     }
 
+    void OutputFormatter::setHexdumpLimit(size_t f_maxBytes)
+    {
+        m_hexdumpLimit = f_maxBytes;
+    }
+
+    bool OutputFormatter::setBytesOutputFile(const std::string & f_fieldPath, const std::string & f_fileName)
+    {
+        m_bytesOutputFile = std::make_shared<std::ofstream>(f_fileName, std::ios::binary | std::ios::trunc);
+        if(not m_bytesOutputFile->is_open())
+        {
+            m_bytesOutputFile.reset();
+            return false;
+        }
+        m_bytesOutputFieldPath = f_fieldPath;
+        m_bytesOutputFileName = f_fileName;
+        return true;
+    }
+
+    void OutputFormatter::setFieldFilter(const std::unordered_set<const google::protobuf::FieldDescriptor*> & f_fields)
+    {
+        m_fieldFilter = f_fields;
+        m_formatInfoCache.clear();
+    }
+
     std::string OutputFormatter::getColor(OutputFormatter::ColorClass f_colorClass)
     {
         auto resultIt = m_colorMap.find(f_colorClass);
@@ -83,9 +126,9 @@ namespace cli
     std::string OutputFormatter::generateHorizontalGuide(size_t f_currentSize, size_t f_targetSize)
     {
         std::string result = getColor(ColorClass::HorizontalGuides);
-        for(;f_currentSize<f_targetSize; f_currentSize++)
+        if(f_currentSize < f_targetSize)
         {
-            result += ".";
+            result.append(f_targetSize - f_currentSize, '.');
         }
         result += getColor(ColorClass::Normal);
         return result;
@@ -173,8 +216,9 @@ std::string OutputFormatter::repeatedFieldValueToString(const grpc::protobuf::Me
             break;
         case grpc::protobuf::FieldDescriptor::Type::TYPE_BYTES:
             {
-                std::string value = reflection->GetRepeatedString(f_message, f_fieldDescriptor, f_fieldIndex);
-                result += stringFromBytes(value, f_modifier, f_currentPrefix + f_initPrefix);
+                std::string scratch;
+                const std::string & value = reflection->GetRepeatedStringReference(f_message, f_fieldDescriptor, f_fieldIndex, &scratch);
+                result += bytesFieldToString(value, f_modifier, f_currentPrefix + f_initPrefix);
             }
             break;
         default:
@@ -201,6 +245,61 @@ bool OutputFormatter::isMapEntryPrimitive(const grpc::protobuf::Descriptor* f_me
     return false;
 }
 
+OutputFormatter::MessageFormatInfo & OutputFormatter::getMessageFormatInfo(const grpc::protobuf::Descriptor* f_messageDescriptor)
+{
+    auto cacheIt = m_formatInfoCache.find(f_messageDescriptor);
+    if(cacheIt != m_formatInfoCache.end())
+    {
+        return cacheIt->second;
+    }
+
+    // a field filter only applies to message types containing filtered fields:
+    bool filterFields = false;
+    for(int i = 0; (i < f_messageDescriptor->field_count()) and (not m_fieldFilter.empty()); i++)
+    {
+        if(m_fieldFilter.count(f_messageDescriptor->field(i)) != 0)
+        {
+            filterFields = true;
+            break;
+        }
+    }
+
+    MessageFormatInfo & formatInfo = m_formatInfoCache[f_messageDescriptor];
+    formatInfo.maxFieldNameLength = 0;
+    for(int i = 0; i< f_messageDescriptor->field_count(); i++)
+    {
+        const google::protobuf::FieldDescriptor * fieldDesc = f_messageDescriptor->field(i);
+        if(filterFields and (m_fieldFilter.count(fieldDesc) == 0))
+        {
+            continue;
+        }
+        formatInfo.fields.push_back(FieldFormatInfo());
+        FieldFormatInfo & fieldInfo = formatInfo.fields.back();
+        fieldInfo.descriptor = fieldDesc;
+        fieldInfo.paddedNameLength = std::numeric_limits<size_t>::max();
+        fieldInfo.isPrimitiveMap = false;
+        fieldInfo.mapKeyDescriptor = nullptr;
+        fieldInfo.mapValueDescriptor = nullptr;
+        if(fieldDesc->is_repeated())
+        {
+            fieldInfo.coloredName = colorize(ColorClass::RepeatedFieldName, fieldDesc->name());
+            formatInfo.repeatedFieldIndices.push_back(formatInfo.fields.size()-1);
+            if(fieldDesc->is_map() and isMapEntryPrimitive(fieldDesc->message_type()))
+            {
+                fieldInfo.isPrimitiveMap = true;
+                fieldInfo.mapKeyDescriptor = fieldDesc->message_type()->field(0);
+                fieldInfo.mapValueDescriptor = fieldDesc->message_type()->field(1);
+            }
+        }
+        else
+        {
+            fieldInfo.coloredName = colorize(ColorClass::NonRepeatedFieldName, fieldDesc->name());
+        }
+        formatInfo.maxFieldNameLength = std::max(formatInfo.maxFieldNameLength, fieldDesc->name().size());
+    }
+    return formatInfo;
+}
+
 std::string OutputFormatter::fieldValueToString(const grpc::protobuf::Message & f_message, const google::protobuf::FieldDescriptor * f_fieldDescriptor, const std::string & f_initPrefix, const std::string & f_currentPrefix, CustomStringModifier f_modifier)
 {
     const google::protobuf::Reflection * reflection = f_message.GetReflection();
@@ -286,8 +385,9 @@ std::string OutputFormatter::fieldValueToString(const grpc::protobuf::Message &
             break;
         case grpc::protobuf::FieldDescriptor::Type::TYPE_BYTES:
             {
-                std::string value = reflection->GetString(f_message, f_fieldDescriptor);
-                result += stringFromBytes(value, f_modifier, f_currentPrefix + f_initPrefix);
+                std::string scratch;
+                const std::string & value = reflection->GetStringReference(f_message, f_fieldDescriptor, &scratch);
+                result += bytesFieldToString(value, f_modifier, f_currentPrefix + f_initPrefix);
             }
             break;
         case grpc::protobuf::FieldDescriptor::Type::TYPE_MESSAGE:
@@ -308,38 +408,39 @@ std::string OutputFormatter::fieldValueToString(const grpc::protobuf::Message &
     return result;
 }
 
-std::string OutputFormatter::fieldToString(const grpc::protobuf::Message & f_message, const google::protobuf::FieldDescriptor * f_fieldDescriptor, const std::string & f_initPrefix, const std::string & f_currentPrefix, size_t maxFieldNameSize)
+std::string OutputFormatter::fieldToString(const grpc::protobuf::Message & f_message, FieldFormatInfo & f_fieldInfo, const std::string & f_initPrefix, const std::string & f_currentPrefix, size_t maxFieldNameSize)
 {
     std::string result;
     const google::protobuf::Reflection * reflection = f_message.GetReflection();
+    const google::protobuf::FieldDescriptor * fieldDescriptor = f_fieldInfo.descriptor;
 
-    if(f_fieldDescriptor->is_repeated())
+    if(fieldDescriptor->is_repeated())
     {
-        int numberOfRepetitions = reflection->FieldSize(f_message, f_fieldDescriptor);
+        int numberOfRepetitions = reflection->FieldSize(f_message, fieldDescriptor);
         if(numberOfRepetitions == 0)
         {
             // TODO: remove duplicate code
             result += colorize(ColorClass::VerticalGuides, f_currentPrefix);
             std::string repName;
-            repName += colorize(ColorClass::RepeatedFieldName, f_fieldDescriptor->name());
+            repName += f_fieldInfo.coloredName;
             repName += colorize(ColorClass::RepeatedCount, "[0/0]");
             result += repName;
             size_t nameSize = repName.size();
             result += generateHorizontalGuide(nameSize, maxFieldNameSize);
             result += " = " + colorize(ColorClass::MessageTypeName, "{}");
         }
-        if(m_isSimpleMapOutput and f_fieldDescriptor->is_map() and isMapEntryPrimitive(f_fieldDescriptor->message_type()))
+        if(m_isSimpleMapOutput and f_fieldInfo.isPrimitiveMap)
         {
             std::map<std::int64_t, const google::protobuf::Message*> int64Map;
             std::map<std::uint64_t, const google::protobuf::Message*> uint64Map;
             std::map<std::string, const google::protobuf::Message*> stringMap;
             for(int i=0; i< numberOfRepetitions; i++)
             {
-                if(f_fieldDescriptor->type() == grpc::protobuf::FieldDescriptor::Type::TYPE_MESSAGE)
+                if(fieldDescriptor->type() == grpc::protobuf::FieldDescriptor::Type::TYPE_MESSAGE)
                 {
                     //using this method to get repeated message from field
-                    const google::protobuf::Message & subMessage = reflection->GetRepeatedMessage(f_message, f_fieldDescriptor, i);
-                    const google::protobuf::FieldDescriptor * k_fieldDescriptor = f_fieldDescriptor->message_type()->field(0);
+                    const google::protobuf::Message & subMessage = reflection->GetRepeatedMessage(f_message, fieldDescriptor, i);
+                    const google::protobuf::FieldDescriptor * k_fieldDescriptor = f_fieldInfo.mapKeyDescriptor;
                     const google::protobuf::Reflection * reflection = subMessage.GetReflection();
                     switch(k_fieldDescriptor->type())
                     {
@@ -385,10 +486,10 @@ std::string OutputFormatter::fieldToString(const grpc::protobuf::Message & f_mes
                 }
             }
             // first determine which map is not empty, and then output it.
-            const google::protobuf::FieldDescriptor * v_fieldDescriptor = f_fieldDescriptor->message_type()->field(1);
+            const google::protobuf::FieldDescriptor * v_fieldDescriptor = f_fieldInfo.mapValueDescriptor;
             if(!int64Map.empty())
             {
-                result += outputMapTitle(int64Map, f_fieldDescriptor, f_currentPrefix);
+                result += outputMapTitle(int64Map, fieldDescriptor, f_currentPrefix);
                 for(auto& p: int64Map)
                 {
                     result += "\n";
@@ -400,7 +501,7 @@ std::string OutputFormatter::fieldToString(const grpc::protobuf::Message & f_mes
             }
             if(!uint64Map.empty())
             {
-                result += outputMapTitle(uint64Map, f_fieldDescriptor, f_currentPrefix);
+                result += outputMapTitle(uint64Map, fieldDescriptor, f_currentPrefix);
                 for(auto& p: uint64Map)
                 {
                     result += "\n";
@@ -412,7 +513,7 @@ std::string OutputFormatter::fieldToString(const grpc::protobuf::Message & f_mes
             }
             if(!stringMap.empty())
             {
-                result += outputMapTitle(stringMap, f_fieldDescriptor, f_currentPrefix);
+                result += outputMapTitle(stringMap, fieldDescriptor, f_currentPrefix);
                 for(auto& p: stringMap)
                 {
                     result += "\n";
@@ -432,24 +533,28 @@ std::string OutputFormatter::fieldToString(const grpc::protobuf::Message & f_mes
             }
             result += colorize(ColorClass::VerticalGuides, f_currentPrefix);
             std::string repName;
-            repName += getColor(ColorClass::RepeatedFieldName) + f_fieldDescriptor->name() + getColor(ColorClass::Normal);
+            repName += f_fieldInfo.coloredName;
             repName += getColor(ColorClass::RepeatedCount) + "[" + std::to_string(i+1) + "/" + std::to_string(numberOfRepetitions) + "]" + getColor(ColorClass::Normal);
             result += repName;
             size_t nameSize = repName.size();
             result += generateHorizontalGuide(nameSize, maxFieldNameSize);
             result += " = ";
-            result += repeatedFieldValueToString(f_message, f_fieldDescriptor, f_initPrefix, f_currentPrefix, i);
+            result += repeatedFieldValueToString(f_message, fieldDescriptor, f_initPrefix, f_currentPrefix, i);
         }
 
     }
     else
     {
         result += colorize(ColorClass::VerticalGuides, f_currentPrefix);
-        result += colorize(ColorClass::NonRepeatedFieldName, f_fieldDescriptor->name());
-        size_t nameSize = f_fieldDescriptor->name().size();
-        result += generateHorizontalGuide(nameSize, maxFieldNameSize);
-        result += " = ";
-        result += fieldValueToString(f_message, f_fieldDescriptor, f_initPrefix, f_currentPrefix);
+        if(f_fieldInfo.paddedNameLength != maxFieldNameSize)
+        {
+            // padding only changes if the repetition count of a repeated field
+            // in the same message grows to a new number of digits:
+            f_fieldInfo.paddedName = f_fieldInfo.coloredName + generateHorizontalGuide(fieldDescriptor->name().size(), maxFieldNameSize) + " = ";
+            f_fieldInfo.paddedNameLength = maxFieldNameSize;
+        }
+        result += f_fieldInfo.paddedName;
+        result += fieldValueToString(f_message, fieldDescriptor, f_initPrefix, f_currentPrefix);
     }
 
     return result;
@@ -458,125 +563,146 @@ std::string OutputFormatter::fieldToString(const grpc::protobuf::Message & f_mes
 std::string OutputFormatter::messageToString(const grpc::protobuf::Message & f_message, const grpc::protobuf::Descriptor* f_messageDescriptor, const std::string & f_initPrefix, const std::string & f_currentPrefix)
 {
     std::string result;
+    MessageFormatInfo & formatInfo = getMessageFormatInfo(f_messageDescriptor);
+
     // first determine field name length maximum (for aligned formatting)
-    size_t maxFieldNameLength = 0;
-    for(int i = 0; i< f_messageDescriptor->field_count(); i++)
+    // only the repetition counters of repeated fields depend on the message content:
+    size_t maxFieldNameLength = formatInfo.maxFieldNameLength;
+    if(not formatInfo.repeatedFieldIndices.empty())
     {
-        const google::protobuf::FieldDescriptor * fieldDesc = f_messageDescriptor->field(i);
-        size_t thisFieldNameLength = fieldDesc->name().size();
-
-        if(fieldDesc->is_repeated())
+        const google::protobuf::Reflection * reflection = f_message.GetReflection();
+        for(size_t fieldIndex : formatInfo.repeatedFieldIndices)
         {
-            const google::protobuf::Reflection * reflection = f_message.GetReflection();
+            const google::protobuf::FieldDescriptor * fieldDesc = formatInfo.fields[fieldIndex].descriptor;
             int numberOfRepetitions = reflection->FieldSize(f_message, fieldDesc);
-            std::string simulatedMaxArr =  "[" + std::to_string(numberOfRepetitions) + "/" + std::to_string(numberOfRepetitions) + "]";
-            thisFieldNameLength += simulatedMaxArr.size();
-            
-            
-        }
-        if(thisFieldNameLength > maxFieldNameLength)
-        {
-            maxFieldNameLength = thisFieldNameLength;
+            // length of simulated "[n/n]" counter:
+            size_t thisFieldNameLength = fieldDesc->name().size() + 3 + 2*std::to_string(numberOfRepetitions).size();
+            if(thisFieldNameLength > maxFieldNameLength)
+            {
+                maxFieldNameLength = thisFieldNameLength;
+            }
         }
     }
 
-    for(int i = 0; i< f_messageDescriptor->field_count(); i++)
+    for(size_t i = 0; i < formatInfo.fields.size(); i++)
     {
-        const google::protobuf::FieldDescriptor * fieldDesc = f_messageDescriptor->field(i);
+        FieldFormatInfo & fieldInfo = formatInfo.fields[i];
         if(i!=0)
         {
             result += "\n";
         }
-        result += fieldToString(f_message, fieldDesc, f_initPrefix, f_currentPrefix, maxFieldNameLength);
+        if(m_bytesOutputFile)
+        {
+            m_fieldPath.push_back(fieldInfo.descriptor->name());
+        }
+        result += fieldToString(f_message, fieldInfo, f_initPrefix, f_currentPrefix, maxFieldNameLength);
+        if(m_bytesOutputFile)
+        {
+            m_fieldPath.pop_back();
+        }
     }
     return result;
 }
 
-std::string OutputFormatter::stringFromBytes(const std::string & f_value, const CustomStringModifier & f_modifier, const std::string & f_prefix)
+std::string OutputFormatter::bytesFieldToString(const std::string & f_value, const CustomStringModifier & f_modifier, const std::string & f_prefix)
 {
-    std::string result;
+    if(m_bytesOutputFile and (f_modifier != CustomStringModifier::Raw))
+    {
+        std::string currentPath;
+        for(const std::string & fieldName : m_fieldPath)
+        {
+            if(not currentPath.empty())
+            {
+                currentPath += ".";
+            }
+            currentPath += fieldName;
+        }
+        if(currentPath == m_bytesOutputFieldPath)
+        {
+            m_bytesOutputFile->write(f_value.data(), f_value.size());
+            m_bytesOutputFile->flush();
+            return "hex[" + std::to_string(f_value.size()) + "] written to '" + m_bytesOutputFileName + "'";
+        }
+    }
+    return stringFromBytes(f_value, f_modifier, f_prefix);
+}
 
+std::string OutputFormatter::stringFromBytes(const std::string & f_value, const CustomStringModifier & f_modifier, const std::string & f_prefix)
+{
     if(f_modifier == CustomStringModifier::Raw)
     {
         return f_value;
     }
-    else // Default, Hex, Dec
-    {
-        // a simple hexdump:
-        const std::string & prefix = f_prefix;
-        result += "hex[" + std::to_string(f_value.size()) + "]";
 
-        std::string stringRepresentation = "";
-        size_t maxAddrTextSize = std::to_string(f_value.size()-1).size();
-        for(size_t i = 0; i<f_value.size(); )
+    // Default, Hex, Dec: a simple hexdump with 8 bytes per line.
+    const size_t totalSize = f_value.size();
+    const size_t dumpSize = std::min(totalSize, m_hexdumpLimit);
+    const bool multiLine = (totalSize > 8);
+    // TODO: should place address as hex also...
+    const size_t maxAddrTextSize = (dumpSize > 0) ? std::to_string(dumpSize-1).size() : 1;
+
+    // All lines have the same layout, so we prepare one line and only patch
+    // address, hex digits and characters before appending it to the result:
+    std::string line = multiLine ? ("\n" + f_prefix + std::string(maxAddrTextSize, ' ') + ": ") : " = ";
+    const size_t hexStart = line.size();
+    line.append(8*3, ' ');
+    line += " |";
+    const size_t charStart = line.size();
+    line.append(8, ' ');
+    line += "|";
+
+    std::string result = "hex[" + std::to_string(totalSize) + "]";
+    result.reserve(result.size() + ((dumpSize+7)/8) * line.size() + f_prefix.size() + 64);
+
+    for(size_t lineStart = 0; lineStart < dumpSize; lineStart += 8)
+    {
+        const size_t lineBytes = std::min<size_t>(8, dumpSize - lineStart);
+        if(multiLine)
         {
-            // first decide on linebreaks, prefix etc:
-            if(i%8 == 0)
-            {
-                if(f_value.size() > 8)
-                {
-                    result += "\n" + prefix;
-                    std::stringstream streamAddr;
-                    streamAddr << std::setfill (' ') << std::setw(maxAddrTextSize);
-                    // TODO: should place address as hex also...
-                    streamAddr << i;
-                    result += streamAddr.str();
-                    result += ": ";
-                }
-                else
-                {
-                    result += " = ";
-                }
-            }
-            else if(i%4 == 0)
-            {
-                result += "  ";
-            }
-            else
-            {
-                result += " ";
-            }
-
-            // now do the actual hexdump:
-            // cast to uint16_t necessary, otherwise stream interprets the value as a char.
-            uint16_t byteVal = f_value[i] & 0xff;
-            std::stringstream stream;
-            stream << std::setfill ('0') << std::setw(2) << std::hex;
-            stream << byteVal;
-            result += stream.str();
-
-            // create string representation:
-            if( (f_value[i] >= 32) and (f_value[i] <= 126) )
+            // right aligned decimal address. Addresses only grow, so digits
+            // of previous lines are always overwritten:
+            size_t addr = lineStart;
+            size_t pos = hexStart - 2;
+            do
+            {
+                line[--pos] = static_cast<char>('0' + addr%10);
+                addr /= 10;
+            } while(addr != 0);
+        }
+        for(size_t j = 0; j < 8; j++)
+        {
+            // one extra space after the first four bytes:
+            const size_t hexPos = hexStart + 3*j + ((j >= 4) ? 1 : 0);
+            if(j < lineBytes)
             {
-                // string representable character range:
-                stringRepresentation += f_value[i];
+                const unsigned char byteVal = static_cast<unsigned char>(f_value[lineStart + j]);
+                line[hexPos] = g_hexTable.m_digits[byteVal][0];
+                line[hexPos+1] = g_hexTable.m_digits[byteVal][1];
+                // string representable character range, otherwise special characters:
+                line[charStart + j] = ((byteVal >= 32) and (byteVal <= 126)) ? static_cast<char>(byteVal) : '.';
             }
             else
             {
-                // special characters
-                stringRepresentation += ".";
+                line[hexPos] = ' ';
+                line[hexPos+1] = ' ';
             }
+        }
 
-            i++;
-
-            // Place string representation, when appropriate:
-            if( (i%8 == 0) or (i>=f_value.size()) )
-            {
-                size_t padding = (8 - i%8)%8;
-                if(padding>3)
-                {
-                    padding *=3;
-                    padding += 1;
-                }
-                else
-                {
-                    padding *=3;
-                }
-                result += std::string(padding, ' ');
-                result += " |" + stringRepresentation + "|";
-                stringRepresentation = "";
-            }
+        if(lineBytes == 8)
+        {
+            result += line;
         }
+        else
+        {
+            // last line is shorter: hex area stays padded, character area does not
+            result.append(line, 0, charStart + lineBytes);
+            result += "|";
+        }
+    }
+
+    if(dumpSize < totalSize)
+    {
+        result += "\n" + f_prefix + "... " + std::to_string(totalSize - dumpSize) + " more bytes not shown";
     }
     return result;
 }
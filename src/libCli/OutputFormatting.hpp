@@ -18,6 +18,11 @@
 #include <sstream>
 #include <iomanip>
 #include <type_traits>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
 
 template <typename T> static void dumpBinaryIntoString(std::string &f_destination, const T& f_source);
 
@@ -73,11 +78,32 @@ namespace cli
 
             /// Clears the color map.
             /// Causes all output to be generated with default font (no terminal control characters).
+            /// Also invalidates the cached formatting information, as it contains colorized strings.
             void clearColorMap();
 
             ///Formats outputted map as key => value
             void disableSimpleMapOutput();
 
+            /// Limits the number of bytes shown in hexdumps of bytes fields.
+            /// Remaining bytes are summarized in one line instead of being dumped.
+            /// @param f_maxBytes maximum number of bytes to dump per field value
+            void setHexdumpLimit(size_t f_maxBytes);
+
+            /// Writes the raw data of a bytes field into a file instead of
+            /// dumping it inline. The file is truncated once and all matching
+            /// values (e.g. of a reply stream) are appended to it.
+            /// @param f_fieldPath dot separated field names, addressing the bytes field
+            ///        relative to the formatted message (e.g. "payload.data")
+            /// @param f_fileName name of the file to write the raw data into
+            /// @returns false if the file could not be opened for writing
+            bool setBytesOutputFile(const std::string & f_fieldPath, const std::string & f_fileName);
+
+            /// Restricts which fields are shown.
+            /// Messages with at least one field in f_fields only show the fields
+            /// in f_fields. Messages of other types are shown completely.
+            /// @param f_fields fields to show, an empty set shows all fields
+            void setFieldFilter(const std::unordered_set<const google::protobuf::FieldDescriptor*> & f_fields);
+
             // TODO: provide the option to provide custom color map
             //       e.g. via config file or cli args
 
@@ -90,12 +116,53 @@ namespace cli
             std::string repeatedFieldValueToString(const grpc::protobuf::Message & f_message, const google::protobuf::FieldDescriptor * f_fieldDescriptor, const std::string & f_initPrefix, const std::string & f_currentPrefix, int f_fieldIndex, CustomStringModifier f_modifier = CustomStringModifier::Default);
 
         private:
+            /// Formatting information of a single field, which only depends on
+            /// the field descriptor and the color map.
+            struct FieldFormatInfo
+            {
+                const google::protobuf::FieldDescriptor * descriptor;
+                /// Colorized field name
+                std::string coloredName;
+                /// Colorized field name, padded with horizontal guides to
+                /// paddedNameLength and followed by " = " (non-repeated fields only).
+                std::string paddedName;
+                size_t paddedNameLength;
+                /// true if this is a map field with primitive key and value types
+                bool isPrimitiveMap;
+                const google::protobuf::FieldDescriptor * mapKeyDescriptor;
+                const google::protobuf::FieldDescriptor * mapValueDescriptor;
+            };
+
+            /// Formatting information of a message type.
+            struct MessageFormatInfo
+            {
+                std::vector<FieldFormatInfo> fields;
+                /// Maximum field name length, not considering the repetition
+                /// counters of repeated fields, as those depend on message content.
+                size_t maxFieldNameLength;
+                /// Indices (into fields) of all repeated fields.
+                std::vector<size_t> repeatedFieldIndices;
+            };
+
+            /// Returns the cached formatting information for the given message
+            /// type, creating it on first use.
+            MessageFormatInfo & getMessageFormatInfo(const grpc::protobuf::Descriptor* f_messageDescriptor);
+
+            std::unordered_map<const grpc::protobuf::Descriptor*, MessageFormatInfo> m_formatInfoCache;
             bool m_isSimpleMapOutput;
             std::map<ColorClass, std::string> m_colorMap;
+            size_t m_hexdumpLimit;
+            std::string m_bytesOutputFieldPath;
+            std::string m_bytesOutputFileName;
+            std::shared_ptr<std::ofstream> m_bytesOutputFile;
+            std::unordered_set<const google::protobuf::FieldDescriptor*> m_fieldFilter;
+            /// Names of the fields currently being formatted (outermost first).
+            /// Only maintained if a bytes output file is set.
+            std::vector<std::string> m_fieldPath;
             std::string generateHorizontalGuide(size_t f_currentSize, size_t f_targetSize);
             std::string getColor(ColorClass f_colorClass);
             std::string colorize(ColorClass f_colorClass, const std::string & f_string);
-            std::string fieldToString(const grpc::protobuf::Message & f_message, const google::protobuf::FieldDescriptor * f_fieldDescriptor, const std::string & f_initPrefix, const std::string & f_currentPrefix, size_t maxFieldNameSize);
+            std::string fieldToString(const grpc::protobuf::Message & f_message, FieldFormatInfo & f_fieldInfo, const std::string & f_initPrefix, const std::string & f_currentPrefix, size_t maxFieldNameSize);
             template <typename T> std::string intToHexString(T f_value);
             // string formatting methods for various types:
             template<typename T>
@@ -184,6 +251,10 @@ namespace cli
 
             std::string stringFromBytes(const std::string & f_value, const CustomStringModifier & f_modifier, const std::string & f_prefix);
 
+            /// Like stringFromBytes, but redirects the value into the bytes output
+            /// file, if the currently formatted field matches the configured field path.
+            std::string bytesFieldToString(const std::string & f_value, const CustomStringModifier & f_modifier, const std::string & f_prefix);
+
             template <typename T>
                 std::string outputMapTitle(std::map<T, const google::protobuf::Message*> f_map, const google::protobuf::FieldDescriptor * f_fieldDescriptor, const std::string & f_currentPrefix)
                 {
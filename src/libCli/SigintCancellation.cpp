@@ -0,0 +1,107 @@
+// Copyright 2019 IBM Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <libCli/SigintCancellation.hpp>
+
+#include <errno.h>
+#include <unistd.h>
+
+namespace cli
+{
+
+static const char s_interruptByte = 'i';
+static const char s_quitByte = 'q';
+
+/// write end of the self-pipe of the current instance (-1 if none)
+static volatile sig_atomic_t s_signalPipe = -1;
+
+SigintCancellation::SigintCancellation(std::function<void()> f_cancel) :
+    m_cancel(f_cancel),
+    m_cancelled(false)
+{
+    m_pipe[0] = -1;
+    m_pipe[1] = -1;
+    if(pipe(m_pipe) != 0)
+    {
+        // without a pipe there is no cancellation, Ctrl+C just terminates as before
+        return;
+    }
+    s_signalPipe = m_pipe[1];
+
+    struct sigaction action;
+    action.sa_handler = &SigintCancellation::handleSignal;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESTART;
+    sigaction(SIGINT, &action, &m_previousAction);
+
+    m_watcher = std::thread(&SigintCancellation::watch, this);
+}
+
+SigintCancellation::~SigintCancellation()
+{
+    if(m_pipe[1] == -1)
+    {
+        return;
+    }
+    sigaction(SIGINT, &m_previousAction, nullptr);
+    s_signalPipe = -1;
+
+    ssize_t rc = write(m_pipe[1], &s_quitByte, 1);
+    (void)rc;
+    m_watcher.join();
+    close(m_pipe[0]);
+    close(m_pipe[1]);
+}
+
+bool SigintCancellation::wasCancelled() const
+{
+    return m_cancelled;
+}
+
+void SigintCancellation::handleSignal(int f_signal)
+{
+    // only async-signal-safe functions may be used here
+    int fd = s_signalPipe;
+    if(fd != -1)
+    {
+        ssize_t rc = write(fd, &s_interruptByte, 1);
+        (void)rc;
+    }
+}
+
+void SigintCancellation::watch()
+{
+    char byte;
+    while(true)
+    {
+        ssize_t rc = read(m_pipe[0], &byte, 1);
+        if((rc == -1) and (errno == EINTR))
+        {
+            continue;
+        }
+        if((rc != 1) or (byte == s_quitByte))
+        {
+            return;
+        }
+        // further signals are ignored. Tools like timeout(1) send SIGINT to
+        // the process and to its process group, so it might arrive twice.
+        if(not m_cancelled.exchange(true))
+        {
+            m_cancel();
+        }
+    }
+}
+
+}
@@ -0,0 +1,60 @@
+// Copyright 2019 IBM Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <signal.h>
+#include <thread>
+
+namespace cli
+{
+    /// Cancels running RPCs when the user presses Ctrl+C.
+    ///
+    /// While an instance exists, SIGINT does not terminate the process.
+    /// Instead the cancel function is called once on a separate thread, which
+    /// is expected to TryCancel() the running calls. The blocked reader then
+    /// returns normally, so received replies and a summary can still be printed.
+    /// Further SIGINTs are ignored until the instance is destroyed.
+    /// Only one instance may exist at a time.
+    class SigintCancellation
+    {
+        public:
+            /// Installs the SIGINT handler.
+            /// @param f_cancel called (at most once) after SIGINT was received. Must be thread-safe.
+            explicit SigintCancellation(std::function<void()> f_cancel);
+
+            /// Restores the previous SIGINT handler.
+            ~SigintCancellation();
+
+            SigintCancellation(const SigintCancellation &) = delete;
+            SigintCancellation & operator=(const SigintCancellation &) = delete;
+
+            /// @returns true if SIGINT was received and the cancel function was called
+            bool wasCancelled() const;
+
+        private:
+            static void handleSignal(int f_signal);
+            void watch();
+
+            std::function<void()> m_cancel;
+            std::atomic<bool> m_cancelled;
+            /// self-pipe: the signal handler writes, the watcher thread reads
+            int m_pipe[2];
+            struct sigaction m_previousAction;
+            std::thread m_watcher;
+    };
+}
@@ -0,0 +1,535 @@
+// Copyright 2019 IBM Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <libCli/StreamAggregator.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <limits>
+
+/// Relative accuracy of percentiles.
+static const double g_quantileRelativeAccuracy = 0.01;
+/// Number of index bits of the distinct counter (2^N registers).
+static const unsigned int g_distinctCounterPrecision = 14;
+
+namespace cli
+{
+
+StreamAggregator::QuantileSketch::QuantileSketch() :
+    m_logGamma(std::log((1.0 + g_quantileRelativeAccuracy) / (1.0 - g_quantileRelativeAccuracy))),
+    m_zeroCount(0),
+    m_count(0)
+{
+}
+
+int StreamAggregator::QuantileSketch::getBucketIndex(double f_absValue) const
+{
+    return static_cast<int>(std::ceil(std::log(f_absValue) / m_logGamma));
+}
+
+double StreamAggregator::QuantileSketch::getBucketValue(int f_index) const
+{
+    // center of bucket (gamma^(i-1), gamma^i] with respect to relative error:
+    double gamma = std::exp(m_logGamma);
+    return 2.0 * std::exp(f_index * m_logGamma) / (gamma + 1.0);
+}
+
+void StreamAggregator::QuantileSketch::add(double f_value)
+{
+    if(not std::isfinite(f_value))
+    {
+        return;
+    }
+    m_count++;
+    if(f_value > 0)
+    {
+        m_positiveBuckets[getBucketIndex(f_value)]++;
+    }
+    else if(f_value < 0)
+    {
+        m_negativeBuckets[getBucketIndex(-f_value)]++;
+    }
+    else
+    {
+        m_zeroCount++;
+    }
+}
+
+double StreamAggregator::QuantileSketch::getQuantile(double f_quantile) const
+{
+    if(m_count == 0)
+    {
+        return 0;
+    }
+    uint64_t rank = static_cast<uint64_t>(f_quantile * (m_count - 1));
+    uint64_t seen = 0;
+    // negative values in ascending order are the ones with the largest absolute value first:
+    for(auto it = m_negativeBuckets.rbegin(); it != m_negativeBuckets.rend(); ++it)
+    {
+        seen += it->second;
+        if(rank < seen)
+        {
+            return -getBucketValue(it->first);
+        }
+    }
+    seen += m_zeroCount;
+    if(rank < seen)
+    {
+        return 0;
+    }
+    for(auto it = m_positiveBuckets.begin(); it != m_positiveBuckets.end(); ++it)
+    {
+        seen += it->second;
+        if(rank < seen)
+        {
+            return getBucketValue(it->first);
+        }
+    }
+    return getBucketValue(m_positiveBuckets.rbegin()->first);
+}
+
+StreamAggregator::DistinctCounter::DistinctCounter() :
+    m_registers(1 << g_distinctCounterPrecision, 0)
+{
+}
+
+void StreamAggregator::DistinctCounter::add(const std::string & f_value)
+{
+    // std::hash quality depends on the standard library, so we mix the bits
+    // once more (splitmix64 finalizer):
+    uint64_t hash = std::hash<std::string>()(f_value);
+    hash = (hash ^ (hash >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    hash = (hash ^ (hash >> 27)) * 0x94d049bb133111ebULL;
+    hash = hash ^ (hash >> 31);
+
+    size_t registerIndex = hash >> (64 - g_distinctCounterPrecision);
+    uint64_t remainingBits = hash << g_distinctCounterPrecision;
+    uint8_t rank = 1;
+    while((rank <= (64 - g_distinctCounterPrecision)) and ((remainingBits & (1ULL << 63)) == 0))
+    {
+        rank++;
+        remainingBits <<= 1;
+    }
+    if(rank > m_registers[registerIndex])
+    {
+        m_registers[registerIndex] = rank;
+    }
+}
+
+uint64_t StreamAggregator::DistinctCounter::getEstimate() const
+{
+    const double numRegisters = static_cast<double>(m_registers.size());
+    double inverseSum = 0;
+    size_t numZeroRegisters = 0;
+    for(uint8_t reg : m_registers)
+    {
+        inverseSum += std::ldexp(1.0, -reg);
+        if(reg == 0)
+        {
+            numZeroRegisters++;
+        }
+    }
+    const double alpha = 0.7213 / (1.0 + 1.079 / numRegisters);
+    double estimate = alpha * numRegisters * numRegisters / inverseSum;
+    if((estimate <= 2.5 * numRegisters) and (numZeroRegisters != 0))
+    {
+        // small range correction (linear counting), which is exact enough to
+        // give correct results for small numbers of distinct values:
+        estimate = numRegisters * std::log(numRegisters / numZeroRegisters);
+    }
+    return static_cast<uint64_t>(std::llround(estimate));
+}
+
+StreamAggregator::StreamAggregator() :
+    m_messageCount(0)
+{
+}
+
+bool StreamAggregator::addAggregate(const grpc::protobuf::Descriptor * f_messageDescriptor, const std::string & f_spec, std::string & f_out_error)
+{
+    Aggregate aggregate;
+    aggregate.spec = f_spec;
+    aggregate.percentile = 0;
+    aggregate.count = 0;
+    aggregate.sum = 0;
+    aggregate.min = std::numeric_limits<double>::infinity();
+    aggregate.max = -std::numeric_limits<double>::infinity();
+
+    size_t separatorPos = f_spec.find(':');
+    std::string opName = f_spec.substr(0, separatorPos);
+    if(separatorPos != std::string::npos)
+    {
+        aggregate.fieldPath = f_spec.substr(separatorPos + 1);
+    }
+
+    if(opName == "count")
+    {
+        aggregate.op = Operator::Count;
+    }
+    else if(opName == "sum")
+    {
+        aggregate.op = Operator::Sum;
+    }
+    else if(opName == "min")
+    {
+        aggregate.op = Operator::Min;
+    }
+    else if(opName == "max")
+    {
+        aggregate.op = Operator::Max;
+    }
+    else if(opName == "mean")
+    {
+        aggregate.op = Operator::Mean;
+    }
+    else if(opName == "distinct")
+    {
+        aggregate.op = Operator::Distinct;
+    }
+    else if((opName.size() > 1) and (opName[0] == 'p') and (opName.find_first_not_of("0123456789.", 1) == std::string::npos))
+    {
+        aggregate.op = Operator::Percentile;
+        aggregate.percentile = std::atof(opName.c_str() + 1);
+        if(aggregate.percentile > 100)
+        {
+            f_out_error = "Percentile in '" + f_spec + "' is larger than 100";
+            return false;
+        }
+    }
+    else
+    {
+        f_out_error = "Unknown aggregate operator '" + opName + "' in '" + f_spec + "'";
+        return false;
+    }
+
+    if(aggregate.fieldPath.empty())
+    {
+        if(aggregate.op != Operator::Count)
+        {
+            f_out_error = "Aggregate '" + f_spec + "' needs a field path (" + opName + ":FIELD_PATH)";
+            return false;
+        }
+        m_aggregates.push_back(aggregate);
+        return true;
+    }
+
+    // resolve field path once, so values can be accessed without name lookups:
+    const grpc::protobuf::Descriptor * messageDescriptor = f_messageDescriptor;
+    size_t nameStart = 0;
+    while(true)
+    {
+        size_t nameEnd = aggregate.fieldPath.find('.', nameStart);
+        std::string fieldName = aggregate.fieldPath.substr(nameStart, (nameEnd == std::string::npos) ? std::string::npos : nameEnd - nameStart);
+        if(messageDescriptor == nullptr)
+        {
+            f_out_error = "Field '" + aggregate.fields.back()->name() + "' in '" + f_spec + "' is not a message field";
+            return false;
+        }
+        const google::protobuf::FieldDescriptor * field = messageDescriptor->FindFieldByName(fieldName);
+        if(field == nullptr)
+        {
+            f_out_error = "No field '" + fieldName + "' in message type '" + messageDescriptor->full_name() + "'";
+            return false;
+        }
+        if((nameEnd != std::string::npos) and field->is_map())
+        {
+            f_out_error = "Field '" + fieldName + "' in '" + f_spec + "' is a map, maps cannot be aggregated";
+            return false;
+        }
+        aggregate.fields.push_back(field);
+        if(nameEnd == std::string::npos)
+        {
+            break;
+        }
+        messageDescriptor = (field->type() == grpc::protobuf::FieldDescriptor::Type::TYPE_MESSAGE) ? field->message_type() : nullptr;
+        nameStart = nameEnd + 1;
+    }
+
+    const google::protobuf::FieldDescriptor * leaf = aggregate.fields.back();
+    bool isNumeric = (leaf->cpp_type() != google::protobuf::FieldDescriptor::CPPTYPE_STRING) and (leaf->cpp_type() != google::protobuf::FieldDescriptor::CPPTYPE_MESSAGE);
+    if((aggregate.op != Operator::Count) and (aggregate.op != Operator::Distinct) and (not isNumeric))
+    {
+        f_out_error = "Field '" + aggregate.fieldPath + "' is not a number, only count and distinct are supported";
+        return false;
+    }
+    if((aggregate.op == Operator::Distinct) and (leaf->cpp_type() == google::protobuf::FieldDescriptor::CPPTYPE_MESSAGE))
+    {
+        f_out_error = "Field '" + aggregate.fieldPath + "' is a message, distinct is not supported";
+        return false;
+    }
+
+    m_aggregates.push_back(aggregate);
+    return true;
+}
+
+void StreamAggregator::addFieldsToProjection(const grpc::protobuf::Descriptor * f_messageDescriptor, FieldProjection & f_projection) const
+{
+    for(const Aggregate & aggregate : m_aggregates)
+    {
+        if(not aggregate.fieldPath.empty())
+        {
+            std::string error;
+            f_projection.addFieldPath(f_messageDescriptor, aggregate.fieldPath, error);
+        }
+    }
+}
+
+void StreamAggregator::countMessage()
+{
+    m_messageCount++;
+}
+
+void StreamAggregator::addMessage(const grpc::protobuf::Message & f_message)
+{
+    m_messageCount++;
+    for(Aggregate & aggregate : m_aggregates)
+    {
+        if(not aggregate.fields.empty())
+        {
+            addValues(aggregate, f_message, 0);
+        }
+    }
+}
+
+void StreamAggregator::addValues(Aggregate & f_aggregate, const grpc::protobuf::Message & f_message, size_t f_pathIndex)
+{
+    const google::protobuf::FieldDescriptor * field = f_aggregate.fields[f_pathIndex];
+    const google::protobuf::Reflection * reflection = f_message.GetReflection();
+    bool isLeaf = (f_pathIndex + 1 == f_aggregate.fields.size());
+
+    if(field->is_repeated())
+    {
+        int numberOfRepetitions = reflection->FieldSize(f_message, field);
+        for(int i = 0; i < numberOfRepetitions; i++)
+        {
+            if(isLeaf)
+            {
+                addValue(f_aggregate, f_message, field, i);
+            }
+            else
+            {
+                addValues(f_aggregate, reflection->GetRepeatedMessage(f_message, field, i), f_pathIndex + 1);
+            }
+        }
+        return;
+    }
+
+    // sub-messages and oneof members which are not set do not contribute values:
+    bool hasPresence = (field->cpp_type() == google::protobuf::FieldDescriptor::CPPTYPE_MESSAGE) or (field->containing_oneof() != nullptr);
+    if(hasPresence and (not reflection->HasField(f_message, field)))
+    {
+        return;
+    }
+    if(isLeaf)
+    {
+        addValue(f_aggregate, f_message, field, -1);
+    }
+    else
+    {
+        addValues(f_aggregate, reflection->GetMessage(f_message, field), f_pathIndex + 1);
+    }
+}
+
+void StreamAggregator::addValue(Aggregate & f_aggregate, const grpc::protobuf::Message & f_message, const google::protobuf::FieldDescriptor * f_field, int f_index)
+{
+    const google::protobuf::Reflection * reflection = f_message.GetReflection();
+    const bool isRepeated = (f_index >= 0);
+    const bool needDistinctKey = (f_aggregate.op == Operator::Distinct);
+    double value = 0;
+    std::string distinctKey;
+
+    switch(f_field->cpp_type())
+    {
+        case google::protobuf::FieldDescriptor::CPPTYPE_INT32:
+            {
+                int32_t intValue = isRepeated ? reflection->GetRepeatedInt32(f_message, f_field, f_index) : reflection->GetInt32(f_message, f_field);
+                value = intValue;
+                if(needDistinctKey)
+                {
+                    distinctKey = std::to_string(intValue);
+                }
+            }
+            break;
+        case google::protobuf::FieldDescriptor::CPPTYPE_INT64:
+            {
+                int64_t intValue = isRepeated ? reflection->GetRepeatedInt64(f_message, f_field, f_index) : reflection->GetInt64(f_message, f_field);
+                value = static_cast<double>(intValue);
+                if(needDistinctKey)
+                {
+                    distinctKey = std::to_string(intValue);
+                }
+            }
+            break;
+        case google::protobuf::FieldDescriptor::CPPTYPE_UINT32:
+            {
+                uint32_t intValue = isRepeated ? reflection->GetRepeatedUInt32(f_message, f_field, f_index) : reflection->GetUInt32(f_message, f_field);
+                value = intValue;
+                if(needDistinctKey)
+                {
+                    distinctKey = std::to_string(intValue);
+                }
+            }
+            break;
+        case google::protobuf::FieldDescriptor::CPPTYPE_UINT64:
+            {
+                uint64_t intValue = isRepeated ? reflection->GetRepeatedUInt64(f_message, f_field, f_index) : reflection->GetUInt64(f_message, f_field);
+                value = static_cast<double>(intValue);
+                if(needDistinctKey)
+                {
+                    distinctKey = std::to_string(intValue);
+                }
+            }
+            break;
+        case google::protobuf::FieldDescriptor::CPPTYPE_DOUBLE:
+        case google::protobuf::FieldDescriptor::CPPTYPE_FLOAT:
+            {
+                if(f_field->cpp_type() == google::protobuf::FieldDescriptor::CPPTYPE_DOUBLE)
+                {
+                    value = isRepeated ? reflection->GetRepeatedDouble(f_message, f_field, f_index) : reflection->GetDouble(f_message, f_field);
+                }
+                else
+                {
+                    value = isRepeated ? reflection->GetRepeatedFloat(f_message, f_field, f_index) : reflection->GetFloat(f_message, f_field);
+                }
+                if(needDistinctKey)
+                {
+                    // exact bit pattern, text representation might merge different values
+                    distinctKey.resize(sizeof(value));
+                    std::memcpy(&distinctKey[0], &value, sizeof(value));
+                }
+            }
+            break;
+        case google::protobuf::FieldDescriptor::CPPTYPE_BOOL:
+            {
+                bool boolValue = isRepeated ? reflection->GetRepeatedBool(f_message, f_field, f_index) : reflection->GetBool(f_message, f_field);
+                value = boolValue ? 1 : 0;
+                distinctKey = boolValue ? "1" : "0";
+            }
+            break;
+        case google::protobuf::FieldDescriptor::CPPTYPE_ENUM:
+            {
+                int enumValue = isRepeated ? reflection->GetRepeatedEnumValue(f_message, f_field, f_index) : reflection->GetEnumValue(f_message, f_field);
+                value = enumValue;
+                if(needDistinctKey)
+                {
+                    distinctKey = std::to_string(enumValue);
+                }
+            }
+            break;
+        case google::protobuf::FieldDescriptor::CPPTYPE_STRING:
+            {
+                if(needDistinctKey)
+                {
+                    std::string scratch;
+                    const std::string & stringValue = isRepeated ? reflection->GetRepeatedStringReference(f_message, f_field, f_index, &scratch) : reflection->GetStringReference(f_message, f_field, &scratch);
+                    f_aggregate.distinct.add(stringValue);
+                }
+                f_aggregate.count++;
+            }
+            return;
+        case google::protobuf::FieldDescriptor::CPPTYPE_MESSAGE:
+        default:
+            f_aggregate.count++;
+            return;
+    }
+
+    f_aggregate.count++;
+    f_aggregate.sum += value;
+    if(value < f_aggregate.min)
+    {
+        f_aggregate.min = value;
+    }
+    if(value > f_aggregate.max)
+    {
+        f_aggregate.max = value;
+    }
+    if(f_aggregate.op == Operator::Percentile)
+    {
+        f_aggregate.sketch.add(value);
+    }
+    else if(needDistinctKey)
+    {
+        f_aggregate.distinct.add(distinctKey);
+    }
+}
+
+std::string StreamAggregator::getSummary() const
+{
+    std::string result = "Aggregates of " + std::to_string(m_messageCount) + " messages:";
+
+    size_t maxSpecSize = 0;
+    for(const Aggregate & aggregate : m_aggregates)
+    {
+        maxSpecSize = std::max(maxSpecSize, aggregate.spec.size());
+    }
+
+    for(const Aggregate & aggregate : m_aggregates)
+    {
+        result += "\n| " + aggregate.spec + std::string(maxSpecSize - aggregate.spec.size(), '.') + " = ";
+        if(aggregate.op == Operator::Count)
+        {
+            result += std::to_string(aggregate.fields.empty() ? m_messageCount : aggregate.count);
+        }
+        else if(aggregate.op == Operator::Distinct)
+        {
+            result += std::to_string(aggregate.distinct.getEstimate());
+        }
+        else if(aggregate.count == 0)
+        {
+            result += "[NO VALUES]";
+        }
+        else
+        {
+            switch(aggregate.op)
+            {
+                case Operator::Sum:
+                    result += std::to_string(aggregate.sum);
+                    break;
+                case Operator::Min:
+                    result += std::to_string(aggregate.min);
+                    break;
+                case Operator::Max:
+                    result += std::to_string(aggregate.max);
+                    break;
+                case Operator::Mean:
+                    result += std::to_string(aggregate.sum / aggregate.count);
+                    break;
+                case Operator::Percentile:
+                    {
+                        // the sketch only approximates values, but min and max are known exactly:
+                        double quantile = aggregate.sketch.getQuantile(aggregate.percentile / 100.0);
+                        quantile = std::min(std::max(quantile, aggregate.min), aggregate.max);
+                        if(aggregate.percentile == 0)
+                        {
+                            quantile = aggregate.min;
+                        }
+                        else if(aggregate.percentile == 100)
+                        {
+                            quantile = aggregate.max;
+                        }
+                        result += std::to_string(quantile);
+                    }
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+    return result;
+}
+
+}
@@ -0,0 +1,123 @@
+// Copyright 2019 IBM Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <third_party/gRPC_utils/proto_reflection_descriptor_database.h>
+#include <libCli/FieldProjection.hpp>
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace cli
+{
+    /// Maintains running aggregates (count, sum, min, max, mean, percentiles,
+    /// distinct count) over fields of a stream of messages.
+    /// Messages are not retained, memory usage is bounded per aggregate.
+    class StreamAggregator
+    {
+        public:
+            StreamAggregator();
+
+            /// Adds an aggregate.
+            /// @param f_messageDescriptor type of the aggregated messages
+            /// @param f_spec "count" or OPERATOR:FIELD_PATH, where OPERATOR is one of
+            ///        count, sum, min, max, mean, distinct or pNN (percentile, e.g. p99 or p99.9)
+            ///        and FIELD_PATH is a list of field names separated by '.'.
+            ///        Repeated fields on the path contribute one value per element.
+            /// @param f_out_error set to a human readable description if the spec is invalid
+            /// @returns false if the spec is invalid
+            bool addAggregate(const grpc::protobuf::Descriptor * f_messageDescriptor, const std::string & f_spec, std::string & f_out_error);
+
+            /// Adds the fields required to compute the aggregates to a projection.
+            void addFieldsToProjection(const grpc::protobuf::Descriptor * f_messageDescriptor, FieldProjection & f_projection) const;
+
+            /// Updates all aggregates with the values of a message.
+            void addMessage(const grpc::protobuf::Message & f_message);
+
+            /// Counts a message without looking at its content.
+            /// May be used instead of addMessage() if no aggregate needs field values.
+            void countMessage();
+
+            /// @returns a human readable summary of all aggregates
+            std::string getSummary() const;
+
+        private:
+            enum class Operator
+            {
+                Count,
+                Sum,
+                Min,
+                Max,
+                Mean,
+                Percentile,
+                Distinct
+            };
+
+            /// Approximates quantiles with a bounded relative error by counting
+            /// values in logarithmically sized buckets.
+            class QuantileSketch
+            {
+                public:
+                    QuantileSketch();
+                    void add(double f_value);
+                    double getQuantile(double f_quantile) const;
+                private:
+                    int getBucketIndex(double f_absValue) const;
+                    double getBucketValue(int f_index) const;
+                    double m_logGamma;
+                    std::map<int, uint64_t> m_positiveBuckets;
+                    std::map<int, uint64_t> m_negativeBuckets;
+                    uint64_t m_zeroCount;
+                    uint64_t m_count;
+            };
+
+            /// Estimates the number of distinct values (HyperLogLog).
+            class DistinctCounter
+            {
+                public:
+                    DistinctCounter();
+                    void add(const std::string & f_value);
+                    uint64_t getEstimate() const;
+                private:
+                    std::vector<uint8_t> m_registers;
+            };
+
+            struct Aggregate
+            {
+                std::string spec;
+                Operator op;
+                /// percentile in [0, 100] (only for Operator::Percentile)
+                double percentile;
+                std::string fieldPath;
+                /// resolved field path, empty for message count
+                std::vector<const google::protobuf::FieldDescriptor*> fields;
+
+                uint64_t count;
+                double sum;
+                double min;
+                double max;
+                QuantileSketch sketch;
+                DistinctCounter distinct;
+            };
+
+            void addValues(Aggregate & f_aggregate, const grpc::protobuf::Message & f_message, size_t f_pathIndex);
+            void addValue(Aggregate & f_aggregate, const grpc::protobuf::Message & f_message, const google::protobuf::FieldDescriptor * f_field, int f_index);
+
+            std::vector<Aggregate> m_aggregates;
+            uint64_t m_messageCount;
+    };
+}
@@ -0,0 +1,141 @@
+// Copyright 2019 IBM Corporation
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <libCli/Tracing.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+
+namespace cli
+{
+
+Tracer::Tracer() :
+    m_enabled(false),
+    m_startTime(std::chrono::steady_clock::now())
+{
+}
+
+void Tracer::setEnabled(bool f_enabled)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if(f_enabled and not m_enabled.load())
+    {
+        m_startTime = std::chrono::steady_clock::now();
+    }
+    if(not f_enabled)
+    {
+        m_spans.clear();
+        m_spans.shrink_to_fit();
+    }
+    m_enabled.store(f_enabled);
+}
+
+void Tracer::addSpan(const char * f_name, const char * f_category, std::chrono::steady_clock::time_point f_start, std::chrono::steady_clock::time_point f_end)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if(not m_enabled.load(std::memory_order_relaxed))
+    {
+        return;
+    }
+    auto threadIndex = m_threadIndices.insert(std::make_pair(std::this_thread::get_id(), static_cast<uint32_t>(m_threadIndices.size()))).first->second;
+    Span span;
+    span.name = f_name;
+    span.category = f_category;
+    span.start = f_start;
+    span.duration = f_end - f_start;
+    span.threadIndex = threadIndex;
+    m_spans.push_back(span);
+}
+
+bool Tracer::writeChromeTrace(const std::string & f_fileName) const
+{
+    std::ofstream file(f_fileName);
+    if(not file.good())
+    {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    // complete events ("ph":"X"), timestamps and durations are in microseconds:
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    char buffer[64];
+    for(size_t i = 0; i < m_spans.size(); i++)
+    {
+        const Span & span = m_spans[i];
+        double start = std::chrono::duration<double, std::micro>(span.start - m_startTime).count();
+        double duration = std::chrono::duration<double, std::micro>(span.duration).count();
+        file << "{\"name\":\"" << span.name << "\",\"cat\":\"" << span.category << "\",\"ph\":\"X\",";
+        snprintf(buffer, sizeof(buffer), "\"ts\":%.3f,\"dur\":%.3f,", start, duration);
+        file << buffer << "\"pid\":1,\"tid\":" << span.threadIndex << "}";
+        file << ((i + 1 < m_spans.size()) ? ",\n" : "\n");
+    }
+    file << "]}\n";
+    return file.good();
+}
+
+std::string Tracer::getSummary() const
+{
+    struct PhaseSummary
+    {
+        const char * name;
+        uint64_t count;
+        std::chrono::steady_clock::duration total;
+        std::chrono::steady_clock::duration max;
+    };
+
+    std::vector<PhaseSummary> phases;
+    size_t maxNameLength = 5;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        // phases are listed in order of their first occurrence:
+        std::map<std::string, size_t> phaseIndices;
+        for(const Span & span : m_spans)
+        {
+            auto phaseIndex = phaseIndices.insert(std::make_pair(std::string(span.name), phases.size()));
+            if(phaseIndex.second)
+            {
+                PhaseSummary phase;
+                phase.name = span.name;
+                phase.count = 0;
+                phase.total = std::chrono::steady_clock::duration::zero();
+                phase.max = std::chrono::steady_clock::duration::zero();
+                phases.push_back(phase);
+                maxNameLength = std::max(maxNameLength, phaseIndex.first->first.size());
+            }
+            PhaseSummary & phase = phases[phaseIndex.first->second];
+            phase.count++;
+            phase.total += span.duration;
+            phase.max = std::max(phase.max, span.duration);
+        }
+    }
+
+    std::string result = "Timing summary (nested phases are included in their parents):\n";
+    char buffer[64];
+    snprintf(buffer, sizeof(buffer), " %10s %12s %12s\n", "calls", "total ms", "max ms");
+    result += "| " + std::string("phase") + std::string(maxNameLength - 5, ' ') + buffer;
+    for(const PhaseSummary & phase : phases)
+    {
+        std::string name = phase.name;
+        snprintf(buffer, sizeof(buffer), " %10llu %12.3f %12.3f\n",
+                static_cast<unsigned long long>(phase.count),
+                std::chrono::duration<double, std::milli>(phase.total).count(),
+                std::chrono::duration<double, std::milli>(phase.max).count());
+        result += "| " + name + std::string(maxNameLength - name.size(), ' ') + buffer;
+    }
+    return result;
+}
+
+}
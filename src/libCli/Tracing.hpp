@@ -0,0 +1,128 @@
+// Copyright 2019 IBM Corporation
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace cli
+{
+    /// Records timed spans of the phases of a gWhisper invocation (grammar
+    /// construction, connect, reflection, argument parsing, RPC, formatting).
+    /// Recorded spans can be written as Chrome trace-event JSON (viewable with
+    /// chrome://tracing or Perfetto) or summarized per phase.
+    /// Tracing is disabled by default. Recording is thread-safe.
+    class Tracer
+    {
+        public:
+            Tracer(const Tracer &) = delete;
+            Tracer & operator=(const Tracer &) = delete;
+
+            static Tracer & getInstance()
+            {
+                static Tracer tracer;
+                return tracer;
+            }
+
+            /// Enables or disables recording. Disabling discards all recorded spans.
+            void setEnabled(bool f_enabled);
+
+            bool isEnabled() const
+            {
+                return m_enabled.load(std::memory_order_relaxed);
+            }
+
+            /// Records a span.
+            /// @param f_name name of the phase. Needs to be a string literal (is not copied).
+            /// @param f_category category of the phase. Needs to be a string literal (is not copied).
+            void addSpan(const char * f_name, const char * f_category, std::chrono::steady_clock::time_point f_start, std::chrono::steady_clock::time_point f_end);
+
+            /// Writes all recorded spans as Chrome trace-event JSON.
+            /// @returns false if the file could not be written
+            bool writeChromeTrace(const std::string & f_fileName) const;
+
+            /// @returns a human readable table with count, total and maximum
+            ///     duration of each phase
+            std::string getSummary() const;
+
+        private:
+            Tracer();
+
+            struct Span
+            {
+                const char * name;
+                const char * category;
+                std::chrono::steady_clock::time_point start;
+                std::chrono::steady_clock::duration duration;
+                uint32_t threadIndex;
+            };
+
+            std::atomic<bool> m_enabled;
+            mutable std::mutex m_mutex;
+            std::chrono::steady_clock::time_point m_startTime;
+            std::vector<Span> m_spans;
+            std::map<std::thread::id, uint32_t> m_threadIndices;
+    };
+
+    /// Records a span of the given name from construction to destruction if
+    /// tracing is enabled.
+    class TraceSpan
+    {
+        public:
+            /// @param f_name name of the phase. Needs to be a string literal (is not copied).
+            /// @param f_category category of the phase. Needs to be a string literal (is not copied).
+            explicit TraceSpan(const char * f_name, const char * f_category = "gwhisper") :
+                m_name(f_name),
+                m_category(f_category),
+                m_enabled(Tracer::getInstance().isEnabled())
+            {
+                if(m_enabled)
+                {
+                    m_start = std::chrono::steady_clock::now();
+                }
+            }
+
+            ~TraceSpan()
+            {
+                end();
+            }
+
+            /// Ends the span before destruction.
+            void end()
+            {
+                if(m_enabled)
+                {
+                    Tracer::getInstance().addSpan(m_name, m_category, m_start, std::chrono::steady_clock::now());
+                    m_enabled = false;
+                }
+            }
+
+            TraceSpan(const TraceSpan &) = delete;
+            TraceSpan & operator=(const TraceSpan &) = delete;
+
+        private:
+            const char * m_name;
+            const char * m_category;
+            bool m_enabled;
+            std::chrono::steady_clock::time_point m_start;
+    };
+}
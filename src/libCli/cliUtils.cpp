@@ -1,9 +1,16 @@
 #include "libCli/cliUtils.hpp"
+#include "libCli/Tracing.hpp"
+
+#include <grpcpp/support/proto_buffer_reader.h>
+
+#include <climits>
+#include <stdexcept>
 
 namespace cli
 {
     bool waitForChannelConnected(std::shared_ptr<grpc::Channel> f_channel, uint32_t f_timeoutMs)
     {
+        TraceSpan span("waitForChannelConnected", "connection");
         gpr_timespec deadline = gpr_time_add(gpr_now(GPR_CLOCK_MONOTONIC), gpr_time_from_micros(f_timeoutMs*1000, GPR_TIMESPAN));
         bool result = f_channel->WaitForConnected(deadline);
         return result;
@@ -22,6 +29,99 @@ namespace cli
         return connectTimeoutMs;
     }
 
+    unsigned long long getUnsignedOption(ArgParse::ParsedElement * f_parseTree, const std::string & f_elementName, unsigned long long f_default)
+    {
+        std::string valueStr = f_parseTree->findFirstChild(f_elementName);
+        if(valueStr == "")
+        {
+            return f_default;
+        }
+        try
+        {
+            return std::stoull(valueStr);
+        }
+        catch(const std::out_of_range &)
+        {
+            return ULLONG_MAX;
+        }
+    }
+
+    std::chrono::system_clock::time_point getDeadline(ArgParse::ParsedElement * f_parseTree, std::chrono::system_clock::time_point f_startTime)
+    {
+        const std::chrono::system_clock::time_point noDeadline = std::chrono::system_clock::time_point::max();
+        unsigned long long deadlineMs = getUnsignedOption(f_parseTree, "Deadline", ULLONG_MAX);
+        // the clock has a finer resolution than milliseconds, adding larger values would overflow it:
+        std::chrono::milliseconds maxDeadline = std::chrono::duration_cast<std::chrono::milliseconds>(noDeadline - f_startTime);
+        if(deadlineMs >= static_cast<unsigned long long>(maxDeadline.count()))
+        {
+            return noDeadline;
+        }
+        return f_startTime + std::chrono::milliseconds(deadlineMs);
+    }
+
+    /// @returns the value of a numeric option, limited to INT_MAX, or -1 if the option is not given.
+    static int getIntOption(ArgParse::ParsedElement * f_parseTree, const std::string & f_elementName)
+    {
+        std::string valueStr = f_parseTree->findFirstChild(f_elementName);
+        if(valueStr == "")
+        {
+            return -1;
+        }
+        // the grammar only allows digits, but the value might be out of range:
+        if(valueStr.size() > 10)
+        {
+            return INT_MAX;
+        }
+        return static_cast<int>(std::min<unsigned long long>(std::stoull(valueStr), INT_MAX));
+    }
+
+    ChannelOptions getChannelOptions(ArgParse::ParsedElement * f_parseTree)
+    {
+        ChannelOptions options;
+        options.maxSendMessageSize = getIntOption(f_parseTree, "MaxSendMessageSize");
+        options.maxReceiveMessageSize = getIntOption(f_parseTree, "MaxReceiveMessageSize");
+        options.compression = f_parseTree->findFirstChild("ChannelCompression");
+        options.keepaliveTimeMs = getIntOption(f_parseTree, "KeepaliveTime");
+        if(f_parseTree->findFirstChild("NoBdpProbe") != "")
+        {
+            options.bdpProbe = 0;
+        }
+        options.initialStreamWindowSize = getIntOption(f_parseTree, "InitialStreamWindowSize");
+        return options;
+    }
+
+    bool getCallCompression(ArgParse::ParsedElement * f_parseTree, grpc_compression_algorithm & f_out_algorithm)
+    {
+        std::string compression = f_parseTree->findFirstChild("CallCompression");
+        if(compression == "")
+        {
+            return false;
+        }
+        f_out_algorithm = getCompressionAlgorithm(compression);
+        return true;
+    }
+
+    grpc_compression_algorithm getCompressionAlgorithm(const std::string & f_name)
+    {
+        if(f_name == "gzip")
+        {
+            return GRPC_COMPRESS_GZIP;
+        }
+        if(f_name == "deflate")
+        {
+            return GRPC_COMPRESS_DEFLATE;
+        }
+        return GRPC_COMPRESS_NONE;
+    }
+
+    bool parseFromByteBuffer(const grpc::ByteBuffer & f_serializedMessage, google::protobuf::Message & f_message)
+    {
+        // the reader needs a mutable buffer, the copy only references the slices:
+        grpc::ByteBuffer buffer(f_serializedMessage);
+        grpc::ProtoBufferReader reader(&buffer);
+        return f_message.ParseFromZeroCopyStream(&reader);
+    }
+
     std::string getGrpcStatusCodeAsString(grpc::StatusCode f_statusCode)
     {
 
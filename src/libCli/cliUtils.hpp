@@ -14,7 +14,11 @@
 
 #pragma once
 #include "libArgParse/ArgParse.hpp"
+#include "libCli/ConnectionManager.hpp"
 #include <grpc++/channel.h>
+#include <grpcpp/support/byte_buffer.h>
+#include <google/protobuf/message.h>
+#include <chrono>
 namespace cli
 {
     /// Wait for a gRPC channel to go into connected state.
@@ -29,6 +33,41 @@ namespace cli
     /// @returns the value as an integer
     uint32_t getConnectTimeoutMs(ArgParse::ParsedElement * f_parseTree, uint32_t f_default = 500);
 
+    /// Retrieves a numeric option (the grammar only allows digits) from the parse tree
+    /// @param f_parseTree Parse-tree which should be searched for the option
+    /// @param f_elementName element name of the option value
+    /// @param f_default default value returned, if parse-tree did not contain the option.
+    /// @returns the value, limited to the maximum of unsigned long long
+    unsigned long long getUnsignedOption(ArgParse::ParsedElement * f_parseTree, const std::string & f_elementName, unsigned long long f_default);
+
+    /// Retrieves the "Deadline" option from the parse tree
+    /// @param f_parseTree Parse-tree which should be searched for the option
+    /// @param f_startTime time the deadline is relative to
+    /// @returns the point in time at which RPCs are cancelled, or
+    ///          std::chrono::system_clock::time_point::max() if there is no deadline
+    ///          or it is beyond what the clock can represent.
+    std::chrono::system_clock::time_point getDeadline(ArgParse::ParsedElement * f_parseTree, std::chrono::system_clock::time_point f_startTime = std::chrono::system_clock::now());
+
+    /// Retrieves the channel tuning options from the parse tree
+    /// @param f_parseTree Parse-tree which should be searched for the options
+    /// @returns the options, defaults for all options which are not given.
+    ChannelOptions getChannelOptions(ArgParse::ParsedElement * f_parseTree);
+
+    /// Retrieves the "CallCompression" option from the parse tree
+    /// @param f_parseTree Parse-tree which should be searched for the option
+    /// @param f_out_algorithm set to the requested compression algorithm of the call
+    /// @returns false if the option is not given (the channel default is used)
+    bool getCallCompression(ArgParse::ParsedElement * f_parseTree, grpc_compression_algorithm & f_out_algorithm);
+
+    /// @param f_name "none", "deflate" or "gzip"
+    /// @returns the corresponding compression algorithm, no compression for unknown names.
+    grpc_compression_algorithm getCompressionAlgorithm(const std::string & f_name);
+
+    /// Parses a message directly from the slices of a received buffer,
+    /// without copying the serialized message into a contiguous string first.
+    /// @returns false if the wire data is malformed
+    bool parseFromByteBuffer(const grpc::ByteBuffer & f_serializedMessage, google::protobuf::Message & f_message);
+
     /// Convert a gRPC status code into a string.
     /// @param f_statusCode The status code to convert.
     /// @returns a string representation if one was found. Empty string otherwise.
@@ -0,0 +1,134 @@
+// Copyright 2019 IBM Corporation
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "BenchmarkUtils.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+using namespace ArgParse;
+
+namespace
+{
+    std::atomic<uint64_t> g_allocationCount(0);
+    std::atomic<uint64_t> g_allocatedBytes(0);
+}
+
+// Count all heap allocations of the benchmark binary:
+void * operator new(size_t f_size)
+{
+    g_allocationCount.fetch_add(1, std::memory_order_relaxed);
+    g_allocatedBytes.fetch_add(f_size, std::memory_order_relaxed);
+    void * result = std::malloc((f_size > 0) ? f_size : 1);
+    if(result == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    return result;
+}
+
+void * operator new[](size_t f_size)
+{
+    return operator new(f_size);
+}
+
+void operator delete(void * f_ptr) noexcept
+{
+    std::free(f_ptr);
+}
+
+void operator delete[](void * f_ptr) noexcept
+{
+    std::free(f_ptr);
+}
+
+void operator delete(void * f_ptr, size_t) noexcept
+{
+    std::free(f_ptr);
+}
+
+void operator delete[](void * f_ptr, size_t) noexcept
+{
+    std::free(f_ptr);
+}
+
+namespace benchUtils
+{
+
+uint64_t getAllocationCount()
+{
+    return g_allocationCount.load(std::memory_order_relaxed);
+}
+
+uint64_t getAllocatedBytes()
+{
+    return g_allocatedBytes.load(std::memory_order_relaxed);
+}
+
+size_t countParsedElements(ParsedElement & f_parseTree)
+{
+    size_t result = 1;
+    for(auto & child : f_parseTree.getChildren())
+    {
+        result += countParsedElements(*child);
+    }
+    return result;
+}
+
+void runParseBenchmark(benchmark::State & f_state, GrammarElement * f_grammar, const std::string & f_input, bool f_expectSuccess, size_t f_candidateLimit)
+{
+    for(auto _ : f_state)
+    {
+        ParsedElement parseTree;
+        parseTree.setCandidateLimit(f_candidateLimit);
+        ParseRc rc = f_grammar->parse(f_input.c_str(), parseTree);
+        benchmark::DoNotOptimize(rc.lenParsed);
+    }
+
+    // counters are taken from one additional (untimed) parse:
+    uint64_t allocationCountBefore = getAllocationCount();
+    uint64_t allocatedBytesBefore = getAllocatedBytes();
+    size_t parsedElements = 0;
+    size_t candidates = 0;
+    bool success = false;
+    {
+        ParsedElement parseTree;
+        parseTree.setCandidateLimit(f_candidateLimit);
+        ParseRc rc = f_grammar->parse(f_input.c_str(), parseTree);
+        success = rc.isGood();
+        parsedElements = countParsedElements(parseTree);
+        candidates = rc.candidates.size();
+        for(auto & candidate : rc.candidates)
+        {
+            parsedElements += countParsedElements(*candidate);
+        }
+    }
+    // read both before inserting counters, which allocates itself:
+    uint64_t allocationCount = getAllocationCount() - allocationCountBefore;
+    uint64_t allocatedBytes = getAllocatedBytes() - allocatedBytesBefore;
+    f_state.counters["allocs"] = static_cast<double>(allocationCount);
+    f_state.counters["allocBytes"] = static_cast<double>(allocatedBytes);
+    f_state.counters["parsedElements"] = static_cast<double>(parsedElements);
+    f_state.counters["candidates"] = static_cast<double>(candidates);
+    f_state.SetBytesProcessed(static_cast<int64_t>(f_state.iterations() * f_input.size()));
+
+    if(f_expectSuccess and not success)
+    {
+        f_state.SkipWithError(("Could not parse '" + f_input + "'").c_str());
+    }
+}
+
+}
@@ -0,0 +1,46 @@
+// Copyright 2019 IBM Corporation
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#pragma once
+
+#include <libArgParse/ArgParse.hpp>
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <limits>
+#include <string>
+
+namespace benchUtils
+{
+    /// @returns number of heap allocations done by this process so far
+    uint64_t getAllocationCount();
+
+    /// @returns number of bytes allocated on the heap by this process so far
+    uint64_t getAllocatedBytes();
+
+    /// @returns number of ParsedElements in the given parse tree (including the root)
+    size_t countParsedElements(ArgParse::ParsedElement & f_parseTree);
+
+    /// Benchmarks parsing of a string with the given grammar.
+    /// Besides time, the following counters are reported per parse:
+    ///  - allocs, allocBytes: heap allocations done while parsing (including
+    ///    destruction of the parse tree)
+    ///  - parsedElements: ParsedElements in the parse tree and all candidate trees
+    ///  - candidates: number of returned completion candidates
+    /// @param f_expectSuccess if true, the benchmark fails if the string cannot be
+    ///        parsed successfully. Set to false for completion benchmarks.
+    /// @param f_candidateLimit see ArgParse::ParsedElement::setCandidateLimit()
+    void runParseBenchmark(benchmark::State & f_state, ArgParse::GrammarElement * f_grammar, const std::string & f_input, bool f_expectSuccess = true, size_t f_candidateLimit = std::numeric_limits<size_t>::max());
+}
@@ -0,0 +1,257 @@
+// Copyright 2019 IBM Corporation
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "BenchmarkUtils.hpp"
+#include <libArgParse/GrammarFactory.hpp>
+#include <libCli/GrammarConstruction.hpp>
+
+#include <unordered_set>
+
+using namespace ArgParse;
+using benchUtils::runParseBenchmark;
+
+// -----------------------------------------------------------------------------
+//          gWhisper CLI grammar with stubbed grammar injectors
+// -----------------------------------------------------------------------------
+// The injectors of the real CLI grammar query a server via reflection. To
+// benchmark the parser only, each injector gets a fixed grammar as child before
+// parsing. GrammarInjector::parse() does not call getGrammar() if a child
+// already exists.
+
+static GrammarElement * createStubServiceGrammar(Grammar & f_grammar)
+{
+    auto result = f_grammar.createElement<Alternation>();
+    result->addChild(f_grammar.createElement<FixedString>("examples.BenchService"));
+    result->addChild(f_grammar.createElement<FixedString>("examples.OtherService"));
+    return result;
+}
+
+static GrammarElement * createStubMethodGrammar(Grammar & f_grammar)
+{
+    auto result = f_grammar.createElement<Alternation>();
+    result->addChild(f_grammar.createElement<FixedString>("benchMethod"));
+    result->addChild(f_grammar.createElement<FixedString>("otherMethod"));
+    return result;
+}
+
+/// Same structure as generated by the MethodArgs injector for a message with
+/// an integer, a string, a bool and a (recursive) sub-message field.
+static GrammarElement * createStubMessageGrammar(Grammar & f_grammar, const std::string & f_rootElementName, GrammarElement * f_wrappingElement, size_t f_maxRecursionDepth)
+{
+    GrammarFactory grammarFactory(f_grammar);
+    auto fieldsAlt = f_grammar.createElement<Alternation>();
+    GrammarElement * message = grammarFactory.createList(
+            f_rootElementName,
+            fieldsAlt,
+            f_grammar.createElement<WhiteSpace>(),
+            false,
+            f_wrappingElement,
+            f_wrappingElement
+            );
+
+    auto numberField = f_grammar.createElement<Concatenation>("Field");
+    numberField->addChild(f_grammar.createElement<FixedString>("number", "FieldName"));
+    numberField->addChild(f_grammar.createElement<FixedString>("="));
+    numberField->addChild(f_grammar.createElement<RegEx>("[\\+-]?(0x|0X|0b)?[0-9a-fA-F]+", "FieldValue"));
+    fieldsAlt->addChild(numberField);
+
+    auto nameField = f_grammar.createElement<Concatenation>("Field");
+    nameField->addChild(f_grammar.createElement<FixedString>("name", "FieldName"));
+    nameField->addChild(f_grammar.createElement<FixedString>("="));
+    nameField->addChild(f_grammar.createElement<EscapedString>(":, %", '%', "FieldValue"));
+    fieldsAlt->addChild(nameField);
+
+    auto enabledField = f_grammar.createElement<Concatenation>("Field");
+    enabledField->addChild(f_grammar.createElement<FixedString>("enabled", "FieldName"));
+    enabledField->addChild(f_grammar.createElement<FixedString>("="));
+    auto boolGrammar = f_grammar.createElement<Alternation>("FieldValue");
+    boolGrammar->addChild(f_grammar.createElement<FixedString>("true"));
+    boolGrammar->addChild(f_grammar.createElement<FixedString>("false"));
+    boolGrammar->addChild(f_grammar.createElement<FixedString>("1"));
+    boolGrammar->addChild(f_grammar.createElement<FixedString>("0"));
+    enabledField->addChild(boolGrammar);
+    fieldsAlt->addChild(enabledField);
+
+    if(f_maxRecursionDepth > 0)
+    {
+        auto subField = f_grammar.createElement<Concatenation>("Field");
+        subField->addChild(f_grammar.createElement<FixedString>("sub", "FieldName"));
+        subField->addChild(f_grammar.createElement<FixedString>("="));
+        subField->addChild(createStubMessageGrammar(f_grammar, "FieldValue", f_grammar.createElement<FixedString>(":"), f_maxRecursionDepth-1));
+        fieldsAlt->addChild(subField);
+    }
+
+    return message;
+}
+
+/// Adds the stub grammars to all injectors reachable from the given element.
+static void stubGrammarInjectors(Grammar & f_grammar, GrammarElement * f_element, std::unordered_set<GrammarElement*> & f_visited)
+{
+    if(not f_visited.insert(f_element).second)
+    {
+        return;
+    }
+    if(f_element->getChildren().empty())
+    {
+        if(f_element->getTypeName() == "GrammarInjector::Service")
+        {
+            f_element->addChild(createStubServiceGrammar(f_grammar));
+        }
+        else if(f_element->getTypeName() == "GrammarInjector::Method")
+        {
+            f_element->addChild(createStubMethodGrammar(f_grammar));
+        }
+        else if(f_element->getTypeName() == "GrammarInjector::MethodArgs")
+        {
+            f_element->addChild(createStubMessageGrammar(f_grammar, "Message", nullptr, 3));
+        }
+        return;
+    }
+    for(GrammarElement * child : f_element->getChildren())
+    {
+        stubGrammarInjectors(f_grammar, child, f_visited);
+    }
+}
+
+static GrammarElement * constructStubbedCliGrammar(Grammar & f_grammar)
+{
+    GrammarElement * root = cli::constructGrammar(f_grammar);
+    std::unordered_set<GrammarElement*> visited;
+    stubGrammarInjectors(f_grammar, root, visited);
+    return root;
+}
+
+static void BM_CliConstructGrammar(benchmark::State & f_state)
+{
+    for(auto _ : f_state)
+    {
+        Grammar grammar;
+        benchmark::DoNotOptimize(cli::constructGrammar(grammar));
+    }
+
+    uint64_t allocationCountBefore = benchUtils::getAllocationCount();
+    {
+        Grammar grammar;
+        benchmark::DoNotOptimize(cli::constructGrammar(grammar));
+    }
+    uint64_t allocationCount = benchUtils::getAllocationCount() - allocationCountBefore;
+    f_state.counters["allocs"] = static_cast<double>(allocationCount);
+}
+BENCHMARK(BM_CliConstructGrammar);
+
+static void BM_CliConstructGrammarStubbed(benchmark::State & f_state)
+{
+    for(auto _ : f_state)
+    {
+        Grammar grammar;
+        benchmark::DoNotOptimize(constructStubbedCliGrammar(grammar));
+    }
+}
+BENCHMARK(BM_CliConstructGrammarStubbed);
+
+static void BM_CliParseCall(benchmark::State & f_state)
+{
+    Grammar grammar;
+    GrammarElement * root = constructStubbedCliGrammar(grammar);
+    runParseBenchmark(f_state, root, "127.0.0.1 examples.BenchService benchMethod number=5 name=hello enabled=true sub=:number=7 name=x:");
+}
+BENCHMARK(BM_CliParseCall);
+
+static void BM_CliParseCallWithOptions(benchmark::State & f_state)
+{
+    Grammar grammar;
+    GrammarElement * root = constructStubbedCliGrammar(grammar);
+    runParseBenchmark(f_state, root, "--noColor --connectTimeoutMilliseconds=500 --formatThreads=4 127.0.0.1:50051 examples.BenchService benchMethod number=5 name=hello");
+}
+BENCHMARK(BM_CliParseCallWithOptions);
+
+static void BM_CliCompleteOption(benchmark::State & f_state)
+{
+    Grammar grammar;
+    GrammarElement * root = constructStubbedCliGrammar(grammar);
+    runParseBenchmark(f_state, root, "--", false);
+}
+BENCHMARK(BM_CliCompleteOption);
+
+static void BM_CliCompleteService(benchmark::State & f_state)
+{
+    Grammar grammar;
+    GrammarElement * root = constructStubbedCliGrammar(grammar);
+    runParseBenchmark(f_state, root, "127.0.0.1 examples.", false);
+}
+BENCHMARK(BM_CliCompleteService);
+
+static void BM_CliCompleteField(benchmark::State & f_state)
+{
+    Grammar grammar;
+    GrammarElement * root = constructStubbedCliGrammar(grammar);
+    runParseBenchmark(f_state, root, "127.0.0.1 examples.BenchService benchMethod number=5 sub=:name=x ", false);
+}
+BENCHMARK(BM_CliCompleteField);
+
+/// Parses the argument line after typing one more character, with the given
+/// number of options in front. With the IncrementalParser (second argument 1),
+/// the options are not parsed again.
+static void BM_CliKeystroke(benchmark::State & f_state)
+{
+    Grammar grammar;
+    GrammarElement * root = constructStubbedCliGrammar(grammar);
+    std::string prefix;
+    for(int64_t i = 0; i < f_state.range(0); i++)
+    {
+        prefix += "--noColor ";
+    }
+    prefix += "127.0.0.1 examples.BenchService benchMethod number=5 name=hel";
+    const std::string inputs[] = {prefix, prefix + "l"};
+    bool incremental = (f_state.range(1) != 0);
+    IncrementalParser parser(root);
+    size_t i = 0;
+    for(auto _ : f_state)
+    {
+        ParsedElement parseTree;
+        const std::string & input = inputs[i++ % 2];
+        ParseRc rc = incremental ? parser.parse(input, parseTree) : root->parse(input.c_str(), parseTree);
+        benchmark::DoNotOptimize(rc.lenParsed);
+    }
+}
+BENCHMARK(BM_CliKeystroke)->ArgsProduct({{0, 8, 64}, {0, 1}});
+
+/// Parses the argument line after typing one more character, with the given
+/// number of method arguments in front. With the IncrementalParser (second
+/// argument 1), only the last method argument is parsed again.
+static void BM_CliKeystrokeMethodArgs(benchmark::State & f_state)
+{
+    Grammar grammar;
+    GrammarElement * root = constructStubbedCliGrammar(grammar);
+    std::string prefix = "127.0.0.1 examples.BenchService benchMethod";
+    for(int64_t i = 0; i < f_state.range(0); i++)
+    {
+        prefix += " number=" + std::to_string(i);
+    }
+    prefix += " name=hel";
+    const std::string inputs[] = {prefix, prefix + "l"};
+    bool incremental = (f_state.range(1) != 0);
+    IncrementalParser parser(root);
+    size_t i = 0;
+    for(auto _ : f_state)
+    {
+        ParsedElement parseTree;
+        const std::string & input = inputs[i++ % 2];
+        ParseRc rc = incremental ? parser.parse(input, parseTree) : root->parse(input.c_str(), parseTree);
+        benchmark::DoNotOptimize(rc.lenParsed);
+    }
+    f_state.counters["reusedLength"] = static_cast<double>(parser.getReusedLength());
+}
+BENCHMARK(BM_CliKeystrokeMethodArgs)->ArgsProduct({{0, 8, 64}, {0, 1}});
@@ -0,0 +1,232 @@
+// Copyright 2019 IBM Corporation
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "BenchmarkUtils.hpp"
+
+using namespace ArgParse;
+using benchUtils::runParseBenchmark;
+
+// -----------------------------------------------------------------------------
+//          Single grammar elements
+// -----------------------------------------------------------------------------
+
+static void BM_FixedString(benchmark::State & f_state)
+{
+    Grammar grammar;
+    auto root = grammar.createElement<FixedString>("--connectTimeoutMilliseconds=");
+    runParseBenchmark(f_state, root, "--connectTimeoutMilliseconds=");
+}
+BENCHMARK(BM_FixedString);
+
+static void BM_RegEx(benchmark::State & f_state)
+{
+    Grammar grammar;
+    auto root = grammar.createElement<RegEx>("[^-:\\[\\] ][^:\\[\\] ]+", "Hostname");
+    runParseBenchmark(f_state, root, "some.host.example.com");
+}
+BENCHMARK(BM_RegEx);
+
+static void BM_WhiteSpace(benchmark::State & f_state)
+{
+    Grammar grammar;
+    auto root = grammar.createElement<WhiteSpace>();
+    runParseBenchmark(f_state, root, "        ");
+}
+BENCHMARK(BM_WhiteSpace);
+
+static void BM_EscapedString(benchmark::State & f_state)
+{
+    Grammar grammar;
+    auto root = grammar.createElement<EscapedString>(":, %", '%', "FieldValue");
+    runParseBenchmark(f_state, root, "some%20string%3Awith%2C%20escapes");
+}
+BENCHMARK(BM_EscapedString);
+
+static void BM_Alternation(benchmark::State & f_state)
+{
+    Grammar grammar;
+    auto root = grammar.createElement<Alternation>();
+    root->addChild(grammar.createElement<FixedString>("true"));
+    root->addChild(grammar.createElement<FixedString>("false"));
+    root->addChild(grammar.createElement<FixedString>("1"));
+    root->addChild(grammar.createElement<FixedString>("0"));
+    runParseBenchmark(f_state, root, "false");
+}
+BENCHMARK(BM_Alternation);
+
+static void BM_Concatenation(benchmark::State & f_state)
+{
+    Grammar grammar;
+    auto root = grammar.createElement<Concatenation>();
+    root->addChild(grammar.createElement<FixedString>("ipv4:"));
+    root->addChild(grammar.createElement<RegEx>("\\d+\\.\\d+\\.\\d+\\.\\d+", "IPv4Address"));
+    root->addChild(grammar.createElement<FixedString>(":"));
+    root->addChild(grammar.createElement<RegEx>("\\d+", "TcpPort"));
+    runParseBenchmark(f_state, root, "ipv4:127.0.0.1:50051");
+}
+BENCHMARK(BM_Concatenation);
+
+static void BM_Repetition(benchmark::State & f_state)
+{
+    Grammar grammar;
+    auto root = grammar.createElement<Repetition>();
+    root->addChild(grammar.createElement<FixedString>("ab"));
+    runParseBenchmark(f_state, root, "abababababababab");
+}
+BENCHMARK(BM_Repetition);
+
+static void BM_Optional(benchmark::State & f_state)
+{
+    Grammar grammar;
+    auto root = grammar.createElement<Optional>();
+    root->addChild(grammar.createElement<FixedString>("dns:"));
+    runParseBenchmark(f_state, root, "dns:");
+}
+BENCHMARK(BM_Optional);
+
+// -----------------------------------------------------------------------------
+//          Synthetic large grammars
+// -----------------------------------------------------------------------------
+
+/// Alternation with N children "choice0" ... "choiceN-1", parsing the last choice.
+static void BM_WideAlternation(benchmark::State & f_state)
+{
+    Grammar grammar;
+    auto root = grammar.createElement<Alternation>();
+    size_t width = static_cast<size_t>(f_state.range(0));
+    for(size_t i = 0; i < width; i++)
+    {
+        root->addChild(grammar.createElement<FixedString>("choice" + std::to_string(i)));
+    }
+    runParseBenchmark(f_state, root, "choice" + std::to_string(width-1));
+}
+BENCHMARK(BM_WideAlternation)->RangeMultiplier(4)->Range(4, 1024);
+
+/// Same as BM_WideAlternation, but completing an empty string (all children are candidates).
+static void BM_WideAlternationComplete(benchmark::State & f_state)
+{
+    Grammar grammar;
+    auto root = grammar.createElement<Alternation>();
+    size_t width = static_cast<size_t>(f_state.range(0));
+    for(size_t i = 0; i < width; i++)
+    {
+        root->addChild(grammar.createElement<FixedString>("choice" + std::to_string(i)));
+    }
+    runParseBenchmark(f_state, root, "", false);
+}
+BENCHMARK(BM_WideAlternationComplete)->RangeMultiplier(4)->Range(4, 1024);
+
+/// Same as BM_WideAlternationComplete, but with a candidate limit of 16 (--completeLimit=16).
+static void BM_WideAlternationCompleteLimited(benchmark::State & f_state)
+{
+    Grammar grammar;
+    auto root = grammar.createElement<Alternation>();
+    size_t width = static_cast<size_t>(f_state.range(0));
+    for(size_t i = 0; i < width; i++)
+    {
+        root->addChild(grammar.createElement<FixedString>("choice" + std::to_string(i)));
+    }
+    runParseBenchmark(f_state, root, "", false, 16);
+}
+BENCHMARK(BM_WideAlternationCompleteLimited)->RangeMultiplier(4)->Range(4, 1024);
+
+/// Nested Concatenation(Optional(Concatenation(...))) of the given depth,
+/// each level consuming one '(' and one ')'.
+static void BM_DeepNesting(benchmark::State & f_state)
+{
+    Grammar grammar;
+    size_t depth = static_cast<size_t>(f_state.range(0));
+    GrammarElement * inner = grammar.createElement<FixedString>("x");
+    for(size_t i = 0; i < depth; i++)
+    {
+        auto level = grammar.createElement<Concatenation>();
+        level->addChild(grammar.createElement<FixedString>("("));
+        auto optional = grammar.createElement<Optional>();
+        optional->addChild(inner);
+        level->addChild(optional);
+        level->addChild(grammar.createElement<FixedString>(")"));
+        inner = level;
+    }
+    runParseBenchmark(f_state, inner, std::string(depth, '(') + "x" + std::string(depth, ')'));
+}
+BENCHMARK(BM_DeepNesting)->RangeMultiplier(4)->Range(4, 256);
+
+/// Repetition of "key=value " entries, parsing the given number of entries.
+static void BM_LongRepetition(benchmark::State & f_state)
+{
+    Grammar grammar;
+    auto entry = grammar.createElement<Concatenation>();
+    entry->addChild(grammar.createElement<RegEx>("[a-z]+", "Key"));
+    entry->addChild(grammar.createElement<FixedString>("="));
+    entry->addChild(grammar.createElement<RegEx>("[0-9]+", "Value"));
+    entry->addChild(grammar.createElement<WhiteSpace>());
+    auto root = grammar.createElement<Repetition>();
+    root->addChild(entry);
+
+    std::string input;
+    for(int64_t i = 0; i < f_state.range(0); i++)
+    {
+        input += "key=" + std::to_string(i) + " ";
+    }
+    runParseBenchmark(f_state, root, input);
+}
+BENCHMARK(BM_LongRepetition)->RangeMultiplier(4)->Range(4, 1024);
+
+/// Repetition of "key=value " entries followed by an incomplete entry, whose
+/// key has 32 candidates. All candidates share the given number of previous entries.
+static void BM_LongRepetitionComplete(benchmark::State & f_state)
+{
+    Grammar grammar;
+    auto keys = grammar.createElement<Alternation>();
+    for(size_t i = 0; i < 32; i++)
+    {
+        keys->addChild(grammar.createElement<FixedString>("key" + std::to_string(i)));
+    }
+    auto entry = grammar.createElement<Concatenation>();
+    entry->addChild(keys);
+    entry->addChild(grammar.createElement<FixedString>("="));
+    entry->addChild(grammar.createElement<RegEx>("[0-9]+", "Value"));
+    entry->addChild(grammar.createElement<WhiteSpace>());
+    auto root = grammar.createElement<Repetition>();
+    root->addChild(entry);
+
+    std::string input;
+    for(int64_t i = 0; i < f_state.range(0); i++)
+    {
+        input += "key1=" + std::to_string(i) + " ";
+    }
+    runParseBenchmark(f_state, root, input + "k", false);
+}
+BENCHMARK(BM_LongRepetitionComplete)->RangeMultiplier(4)->Range(4, 1024);
+
+/// Concatenation of the given number of fixed strings followed by an
+/// Alternation with 32 candidates, completing after all fixed strings.
+static void BM_LongConcatenationComplete(benchmark::State & f_state)
+{
+    Grammar grammar;
+    auto root = grammar.createElement<Concatenation>();
+    for(int64_t i = 0; i < f_state.range(0); i++)
+    {
+        root->addChild(grammar.createElement<FixedString>("a"));
+    }
+    auto choices = grammar.createElement<Alternation>();
+    for(size_t i = 0; i < 32; i++)
+    {
+        choices->addChild(grammar.createElement<FixedString>("choice" + std::to_string(i)));
+    }
+    root->addChild(choices);
+    runParseBenchmark(f_state, root, std::string(static_cast<size_t>(f_state.range(0)), 'a'), false);
+}
+BENCHMARK(BM_LongConcatenationComplete)->RangeMultiplier(4)->Range(4, 1024);
@@ -0,0 +1,506 @@
+// Copyright 2019 IBM Corporation
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+// End-to-end RPC throughput benchmark.
+// Starts the testServer on a unix socket and runs gwhisper against the
+// examples.BenchmarkRpcs service in unary, server-, client- and bidi-streaming
+// mode. For each mode messages/s, payload bytes/s, CPU time and peak RSS of
+// the gwhisper process are measured and written as JSON.
+// Optionally the results are checked against a threshold file.
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace
+{
+
+struct BenchmarkResult
+{
+    std::string name;
+    uint64_t messages = 0;
+    uint64_t payloadBytes = 0;
+    double wallSeconds = 0;
+    double cpuSeconds = 0;
+    long peakRssKiB = 0;
+
+    double getMessagesPerSecond() const
+    {
+        return (wallSeconds > 0) ? messages / wallSeconds : 0;
+    }
+
+    double getBytesPerSecond() const
+    {
+        return (wallSeconds > 0) ? payloadBytes / wallSeconds : 0;
+    }
+
+    /// @returns the value of a metric by name, false if there is no such metric
+    bool getMetric(const std::string & f_metric, double & f_out_value) const
+    {
+        if(f_metric == "messagesPerSecond")
+        {
+            f_out_value = getMessagesPerSecond();
+        }
+        else if(f_metric == "bytesPerSecond")
+        {
+            f_out_value = getBytesPerSecond();
+        }
+        else if(f_metric == "wallSeconds")
+        {
+            f_out_value = wallSeconds;
+        }
+        else if(f_metric == "cpuSeconds")
+        {
+            f_out_value = cpuSeconds;
+        }
+        else if(f_metric == "peakRssKiB")
+        {
+            f_out_value = static_cast<double>(peakRssKiB);
+        }
+        else
+        {
+            return false;
+        }
+        return true;
+    }
+};
+
+double toSeconds(const struct timeval & f_time)
+{
+    return f_time.tv_sec + f_time.tv_usec / 1000000.0;
+}
+
+/// Runs gwhisper with the given arguments, counts received messages and adds
+/// resource usage to f_out_result.
+/// @returns false if gwhisper could not be executed or reported an error
+bool runGwhisper(const std::string & f_gwhisper, const std::vector<std::string> & f_args, uint64_t & f_out_receivedMessages, BenchmarkResult & f_out_result)
+{
+    int outputPipe[2];
+    if(pipe(outputPipe) != 0)
+    {
+        std::cerr << "Error: Could not create pipe: " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    std::vector<char*> argv;
+    argv.push_back(const_cast<char*>(f_gwhisper.c_str()));
+    for(const std::string & arg : f_args)
+    {
+        argv.push_back(const_cast<char*>(arg.c_str()));
+    }
+    argv.push_back(nullptr);
+
+    std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+    pid_t pid = fork();
+    if(pid < 0)
+    {
+        std::cerr << "Error: Could not fork: " << strerror(errno) << std::endl;
+        return false;
+    }
+    if(pid == 0)
+    {
+        // child: stdout and stderr go to the pipe
+        dup2(outputPipe[1], STDOUT_FILENO);
+        dup2(outputPipe[1], STDERR_FILENO);
+        close(outputPipe[0]);
+        close(outputPipe[1]);
+        execv(argv[0], argv.data());
+        _exit(127);
+    }
+    close(outputPipe[1]);
+
+    // count "Received message:" lines, also across read chunk boundaries:
+    const std::string receivedMarker = "Received message:";
+    const std::string succeededMarker = "RPC succeeded";
+    bool succeeded = false;
+    std::string carry;
+    char buffer[65536];
+    while(true)
+    {
+        ssize_t len = read(outputPipe[0], buffer, sizeof(buffer));
+        if(len < 0 and errno == EINTR)
+        {
+            continue;
+        }
+        if(len <= 0)
+        {
+            break;
+        }
+        std::string chunk = carry + std::string(buffer, len);
+        size_t pos = 0;
+        while((pos = chunk.find(receivedMarker, pos)) != std::string::npos)
+        {
+            f_out_receivedMessages++;
+            pos += receivedMarker.size();
+        }
+        if(chunk.find(succeededMarker) != std::string::npos)
+        {
+            succeeded = true;
+        }
+        // the carry is too short to contain a complete marker, which would be counted twice:
+        size_t carryLen = std::min(chunk.size(), receivedMarker.size() - 1);
+        carry = chunk.substr(chunk.size() - carryLen);
+    }
+    close(outputPipe[0]);
+
+    int status = 0;
+    struct rusage usage;
+    if(wait4(pid, &status, 0, &usage) < 0)
+    {
+        std::cerr << "Error: Could not wait for gwhisper: " << strerror(errno) << std::endl;
+        return false;
+    }
+    f_out_result.wallSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    f_out_result.cpuSeconds += toSeconds(usage.ru_utime) + toSeconds(usage.ru_stime);
+    f_out_result.peakRssKiB = std::max(f_out_result.peakRssKiB, usage.ru_maxrss);
+
+    if(not (WIFEXITED(status) and (WEXITSTATUS(status) == 0) and succeeded))
+    {
+        std::cerr << "Error: gwhisper did not complete the RPC successfully." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+/// Starts the testServer listening on the given address.
+/// @returns pid of the server or -1 on error
+pid_t startServer(const std::string & f_testServer, const std::string & f_socketPath)
+{
+    unlink(f_socketPath.c_str());
+    std::string address = "unix:" + f_socketPath;
+    pid_t pid = fork();
+    if(pid < 0)
+    {
+        std::cerr << "Error: Could not fork: " << strerror(errno) << std::endl;
+        return -1;
+    }
+    if(pid == 0)
+    {
+        int devNull = open("/dev/null", O_WRONLY);
+        dup2(devNull, STDOUT_FILENO);
+        execl(f_testServer.c_str(), f_testServer.c_str(), address.c_str(), static_cast<char*>(nullptr));
+        _exit(127);
+    }
+
+    // wait until the socket exists:
+    for(int i = 0; i < 500; i++)
+    {
+        struct stat socketStat;
+        if(stat(f_socketPath.c_str(), &socketStat) == 0)
+        {
+            return pid;
+        }
+        if(waitpid(pid, nullptr, WNOHANG) == pid)
+        {
+            std::cerr << "Error: testServer exited unexpectedly." << std::endl;
+            return -1;
+        }
+        usleep(10000);
+    }
+    std::cerr << "Error: testServer did not create '" << f_socketPath << "'." << std::endl;
+    kill(pid, SIGTERM);
+    waitpid(pid, nullptr, 0);
+    return -1;
+}
+
+std::string getHexPayload(size_t f_payloadSize)
+{
+    static const char * hexDigits = "0123456789abcdef";
+    std::string result = "0x";
+    for(size_t i = 0; i < f_payloadSize; i++)
+    {
+        unsigned char byte = static_cast<unsigned char>(i);
+        result += hexDigits[byte >> 4];
+        result += hexDigits[byte & 0xf];
+    }
+    return result;
+}
+
+/// Appends client stream arguments for f_count payloads to f_args.
+void addRequestStreamArgs(std::vector<std::string> & f_args, uint64_t f_count, const std::string & f_hexPayload)
+{
+    for(uint64_t i = 0; i < f_count; i++)
+    {
+        f_args.push_back(":sequence_number=" + std::to_string(i));
+        f_args.push_back("data=" + f_hexPayload + ":");
+    }
+}
+
+std::string toJson(const std::vector<BenchmarkResult> & f_results, uint64_t f_payloadSize)
+{
+    std::ostringstream json;
+    json << std::fixed << std::setprecision(6);
+    json << "{\n";
+    json << "  \"payloadSize\": " << f_payloadSize << ",\n";
+    json << "  \"benchmarks\": [\n";
+    for(size_t i = 0; i < f_results.size(); i++)
+    {
+        const BenchmarkResult & result = f_results[i];
+        json << "    {\n";
+        json << "      \"name\": \"" << result.name << "\",\n";
+        json << "      \"messages\": " << result.messages << ",\n";
+        json << "      \"payloadBytes\": " << result.payloadBytes << ",\n";
+        json << "      \"wallSeconds\": " << result.wallSeconds << ",\n";
+        json << "      \"messagesPerSecond\": " << result.getMessagesPerSecond() << ",\n";
+        json << "      \"bytesPerSecond\": " << result.getBytesPerSecond() << ",\n";
+        json << "      \"cpuSeconds\": " << result.cpuSeconds << ",\n";
+        json << "      \"peakRssKiB\": " << result.peakRssKiB << "\n";
+        json << "    }" << ((i + 1 < f_results.size()) ? "," : "") << "\n";
+    }
+    json << "  ]\n";
+    json << "}\n";
+    return json.str();
+}
+
+/// Checks results against a threshold file.
+/// Each non-empty line not starting with '#' has the format
+///   BENCHMARK METRIC min|max VALUE
+/// e.g. "serverStream messagesPerSecond min 1000"
+/// @returns false if a threshold is violated or the file is invalid
+bool checkThresholds(const std::string & f_thresholdFile, const std::vector<BenchmarkResult> & f_results)
+{
+    std::ifstream file(f_thresholdFile);
+    if(not file.good())
+    {
+        std::cerr << "Error: Could not open threshold file '" << f_thresholdFile << "'." << std::endl;
+        return false;
+    }
+
+    bool result = true;
+    std::string line;
+    size_t lineNumber = 0;
+    while(std::getline(file, line))
+    {
+        lineNumber++;
+        if(line.empty() or line[0] == '#')
+        {
+            continue;
+        }
+        std::istringstream lineStream(line);
+        std::string benchmark, metric, bound;
+        double threshold;
+        if(not (lineStream >> benchmark >> metric >> bound >> threshold) or ((bound != "min") and (bound != "max")))
+        {
+            std::cerr << "Error: Invalid threshold in line " << lineNumber << ": '" << line << "'" << std::endl;
+            return false;
+        }
+
+        for(const BenchmarkResult & benchmarkResult : f_results)
+        {
+            if(benchmarkResult.name != benchmark)
+            {
+                continue;
+            }
+            double value;
+            if(not benchmarkResult.getMetric(metric, value))
+            {
+                std::cerr << "Error: Unknown metric '" << metric << "' in line " << lineNumber << std::endl;
+                return false;
+            }
+            bool violated = (bound == "min") ? (value < threshold) : (value > threshold);
+            std::cerr << (violated ? "FAILED: " : "ok:     ") << benchmark << " " << metric << " = " << value << " (" << bound << " " << threshold << ")" << std::endl;
+            if(violated)
+            {
+                result = false;
+            }
+        }
+    }
+    return result;
+}
+
+void printUsage()
+{
+    std::cerr << "Usage: gwhisper_rpc_bench BUILD_DIR [OPTIONS]" << std::endl;
+    std::cerr << "  BUILD_DIR: directory containing the gwhisper and testServer executables" << std::endl;
+    std::cerr << "OPTIONS:" << std::endl;
+    std::cerr << "  --messages=N       messages per streaming benchmark (default: 1000)" << std::endl;
+    std::cerr << "  --unaryCalls=N     gwhisper invocations of the unary benchmark (default: 20)" << std::endl;
+    std::cerr << "  --payloadSize=N    data bytes per message (default: 64)" << std::endl;
+    std::cerr << "  --json=FILE        write results to FILE instead of stdout" << std::endl;
+    std::cerr << "  --thresholds=FILE  fail if results violate the thresholds in FILE" << std::endl;
+}
+
+bool getOption(const std::string & f_arg, const std::string & f_option, std::string & f_out_value)
+{
+    if(f_arg.compare(0, f_option.size(), f_option) != 0)
+    {
+        return false;
+    }
+    f_out_value = f_arg.substr(f_option.size());
+    return true;
+}
+
+}
+
+int main(int argc, char **argv)
+{
+    if(argc < 2 or std::string(argv[1]) == "-h" or std::string(argv[1]) == "--help")
+    {
+        printUsage();
+        return (argc < 2) ? -1 : 0;
+    }
+
+    std::string buildDir = argv[1];
+    uint64_t messages = 1000;
+    uint64_t unaryCalls = 20;
+    uint64_t payloadSize = 64;
+    std::string jsonFile;
+    std::string thresholdFile;
+    for(int i = 2; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        std::string value;
+        if(getOption(arg, "--messages=", value))
+        {
+            messages = std::stoull(value);
+        }
+        else if(getOption(arg, "--unaryCalls=", value))
+        {
+            unaryCalls = std::stoull(value);
+        }
+        else if(getOption(arg, "--payloadSize=", value))
+        {
+            payloadSize = std::stoull(value);
+        }
+        else if(getOption(arg, "--json=", value))
+        {
+            jsonFile = value;
+        }
+        else if(getOption(arg, "--thresholds=", value))
+        {
+            thresholdFile = value;
+        }
+        else
+        {
+            std::cerr << "Error: Unknown option '" << arg << "'" << std::endl;
+            printUsage();
+            return -1;
+        }
+    }
+
+    std::string gwhisper = buildDir + "/gwhisper";
+    std::string socketPath = "/tmp/gwhisper_rpc_bench_" + std::to_string(getpid()) + ".sock";
+    pid_t serverPid = startServer(buildDir + "/testServer", socketPath);
+    if(serverPid < 0)
+    {
+        return -1;
+    }
+
+    const std::string serverUri = "unix:" + socketPath;
+    const std::string service = "examples.BenchmarkRpcs";
+    const std::string hexPayload = getHexPayload(payloadSize);
+    std::vector<BenchmarkResult> results;
+    bool ok = true;
+
+    // unary: one gwhisper invocation per message
+    {
+        BenchmarkResult result;
+        result.name = "unary";
+        uint64_t received = 0;
+        for(uint64_t i = 0; (i < unaryCalls) and ok; i++)
+        {
+            ok = runGwhisper(gwhisper, {serverUri, service, "echoPayload", "sequence_number=" + std::to_string(i), "data=" + hexPayload}, received, result);
+        }
+        result.messages = received;
+        result.payloadBytes = 2 * received * payloadSize;
+        results.push_back(result);
+    }
+
+    // server stream:
+    if(ok)
+    {
+        BenchmarkResult result;
+        result.name = "serverStream";
+        uint64_t received = 0;
+        ok = runGwhisper(gwhisper, {serverUri, service, "replyStreamFlood", "count=" + std::to_string(messages), "payload_size=" + std::to_string(payloadSize)}, received, result);
+        result.messages = received;
+        result.payloadBytes = received * payloadSize;
+        results.push_back(result);
+    }
+
+    // client stream: only a single reply is received
+    if(ok)
+    {
+        BenchmarkResult result;
+        result.name = "clientStream";
+        uint64_t received = 0;
+        std::vector<std::string> args = {serverUri, service, "requestStreamFlood"};
+        addRequestStreamArgs(args, messages, hexPayload);
+        ok = runGwhisper(gwhisper, args, received, result);
+        result.messages = ok ? messages : 0;
+        result.payloadBytes = result.messages * payloadSize;
+        results.push_back(result);
+    }
+
+    // bidi stream: every request is echoed
+    if(ok)
+    {
+        BenchmarkResult result;
+        result.name = "bidiStream";
+        uint64_t received = 0;
+        std::vector<std::string> args = {serverUri, service, "bidirectionalStreamEchoPayload"};
+        addRequestStreamArgs(args, messages, hexPayload);
+        ok = runGwhisper(gwhisper, args, received, result);
+        result.messages = received;
+        result.payloadBytes = 2 * received * payloadSize;
+        results.push_back(result);
+    }
+
+    kill(serverPid, SIGTERM);
+    waitpid(serverPid, nullptr, 0);
+    unlink(socketPath.c_str());
+
+    if(not ok)
+    {
+        return -1;
+    }
+
+    std::string json = toJson(results, payloadSize);
+    if(jsonFile.empty())
+    {
+        std::cout << json;
+    }
+    else
+    {
+        std::ofstream file(jsonFile);
+        file << json;
+        if(not file.good())
+        {
+            std::cerr << "Error: Could not write '" << jsonFile << "'." << std::endl;
+            return -1;
+        }
+        std::cerr << "Results written to '" << jsonFile << "'." << std::endl;
+    }
+
+    if((not thresholdFile.empty()) and (not checkThresholds(thresholdFile, results)))
+    {
+        return -1;
+    }
+    return 0;
+}
@@ -0,0 +1,130 @@
+// Copyright 2019 IBM Corporation
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+// Generates a large synthetic proto schema used to stress gWhisper's grammar
+// construction and completion. See doc/Developer.md for details.
+
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+namespace
+{
+    std::string getNumberedName(const std::string & f_prefix, size_t f_number, size_t f_width)
+    {
+        std::ostringstream result;
+        result << f_prefix << std::setw(f_width) << std::setfill('0') << f_number;
+        return result.str();
+    }
+
+    bool parseCount(const char * f_arg, size_t & f_out_value)
+    {
+        char * end = nullptr;
+        unsigned long value = std::strtoul(f_arg, &end, 10);
+        if((end == f_arg) or (*end != '\0') or (value == 0))
+        {
+            std::cerr << "Error: '" << f_arg << "' is not a positive number." << std::endl;
+            return false;
+        }
+        f_out_value = value;
+        return true;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    if(argc < 2 or std::string(argv[1]) == "-h" or std::string(argv[1]) == "--help")
+    {
+        std::cout << "Generates a large synthetic proto schema (package 'stress')." << std::endl << std::endl;
+        std::cout << "SYNOPSIS:" << std::endl;
+        std::cout << "generateStressProto OUTPUT_FILE [SERVICES [METHODS_PER_SERVICE [ENUM_VALUES [NESTING_DEPTH [SCALAR_FIELDS]]]]]" << std::endl << std::endl;
+        std::cout << "Defaults: 20 services, 100 methods per service, 2000 enum values," << std::endl;
+        std::cout << "          nesting depth 15, 200 scalar fields" << std::endl;
+        return (argc < 2) ? -1 : 0;
+    }
+
+    // numServices, methodsPerService, enumValues, nestingDepth, scalarFields:
+    size_t counts[5] = {20, 100, 2000, 15, 200};
+    for(int i = 2; (i < argc) and (i < 7); i++)
+    {
+        if(not parseCount(argv[i], counts[i-2]))
+        {
+            return -1;
+        }
+    }
+    const size_t numServices = counts[0];
+    const size_t methodsPerService = counts[1];
+    const size_t enumValues = counts[2];
+    const size_t nestingDepth = counts[3];
+    const size_t scalarFields = counts[4];
+
+    std::ostringstream proto;
+    proto << "// Generated by generateStressProto, do not edit." << std::endl;
+    proto << "syntax = \"proto3\";" << std::endl << std::endl;
+    proto << "package stress;" << std::endl << std::endl;
+
+    proto << "enum BigEnum" << std::endl << "{" << std::endl;
+    for(size_t i = 0; i < enumValues; i++)
+    {
+        proto << "    " << getNumberedName("BIG_ENUM_VALUE_", i, 4) << " = " << i << ";" << std::endl;
+    }
+    proto << "}" << std::endl << std::endl;
+
+    // Level0 is the innermost message, each level contains the one below:
+    for(size_t level = 0; level < nestingDepth; level++)
+    {
+        proto << "message " << getNumberedName("Level", level, 2) << std::endl << "{" << std::endl;
+        proto << "    int32 number = 1;" << std::endl;
+        proto << "    string text = 2;" << std::endl;
+        proto << "    BigEnum choice = 3;" << std::endl;
+        if(level > 0)
+        {
+            proto << "    " << getNumberedName("Level", level - 1, 2) << " child = 4;" << std::endl;
+        }
+        proto << "}" << std::endl << std::endl;
+    }
+
+    static const char * scalarTypes[] = {"int32", "uint64", "double", "bool", "string", "sint64", "float", "bytes"};
+    proto << "message StressRequest" << std::endl << "{" << std::endl;
+    proto << "    BigEnum choice = 1;" << std::endl;
+    proto << "    " << getNumberedName("Level", nestingDepth - 1, 2) << " nested = 2;" << std::endl;
+    for(size_t i = 0; i < scalarFields; i++)
+    {
+        proto << "    " << scalarTypes[i % 8] << " " << getNumberedName("field_", i, 4) << " = " << (i + 3) << ";" << std::endl;
+    }
+    proto << "}" << std::endl << std::endl;
+
+    for(size_t service = 0; service < numServices; service++)
+    {
+        proto << "service " << getNumberedName("StressService", service, 3) << std::endl << "{" << std::endl;
+        for(size_t method = 0; method < methodsPerService; method++)
+        {
+            proto << "    rpc " << getNumberedName("stressMethod", method, 4) << "(StressRequest) returns (StressRequest) {}" << std::endl;
+        }
+        proto << "}" << std::endl << std::endl;
+    }
+
+    std::ofstream outFile(argv[1]);
+    outFile << proto.str();
+    if(not outFile)
+    {
+        std::cerr << "Error: Could not write '" << argv[1] << "'." << std::endl;
+        return -1;
+    }
+    return 0;
+}
@@ -0,0 +1,184 @@
+#!/bin/bash
+# Copyright 2019 IBM Corporation
+# 
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+# 
+#     http://www.apache.org/licenses/LICENSE-2.0
+# 
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+# Completion and parse latency tests against the stressServer, which exposes a
+# large generated schema (see generateStressProto.cpp).
+# it receives one mandatory argument:
+# 1. the path to the build directory of gWhisper
+# Each scenario is executed up to three times. The test fails if the output is
+# not as expected or if no run stays within the scenario's latency budget.
+# Budgets are relative to the calibration scenario (completing services), which
+# is executed first: they are given in percent of its best latency in the same
+# test run, so they follow the speed and load of the machine. They are about 1.5
+# times the ratio measured over several runs (debug build, one core), but at
+# least 300% (and 50ms) so process start up does not dominate small scenarios.
+# A regression doubling the work of a scenario therefore fails.
+# Build configurations which slow down some scenarios more than the calibration
+# (e.g. sanitizers) can scale all budgets by setting
+# GWHISPER_STRESS_BUDGET_PERCENT (default: 100).
+
+# cli arguments
+build=$1
+gwhisper=$build/gwhisper
+budgetPercent=${GWHISPER_STRESS_BUDGET_PERCENT:-100}
+runsPerScenario=3
+runsForCalibration=5
+minBudgetMs=50
+
+# colors
+RED='\033[0;31m'
+GREEN='\033[0;32m'
+NC='\033[0m'
+
+socket=/tmp/gwhisper_stress_$$.sock
+server=unix:$socket
+
+# starting stress server
+echo "Starting server: $build/stressServer $server ...";
+rm -f $socket
+$build/stressServer $server > /dev/null &
+serverPID=$!
+for i in $(seq 100); do
+    [ -S $socket ] && break
+    sleep 0.05
+done
+
+failedTests=()
+numTests=0
+
+# runs a scenario and checks number of output lines matching a regex and latency
+# 1. scenario name
+# 2. latency budget in percent of the calibration latency
+# 3. expected number of output lines matching the regex
+# 4. regex
+# all other arguments are passed to gwhisper
+runScenario() {
+    local name=$1
+    local budgetMs=$(($2*calibrationMs/100*budgetPercent/100))
+    if [ $budgetMs -lt $minBudgetMs ]; then
+        budgetMs=$minBudgetMs
+    fi
+    local expectedCount=$3
+    local regex=$4
+    shift 4
+    ((numTests=numTests+1))
+    echo "#################################################################"
+    echo "Executing scenario '$name'"
+    measureScenario $runsPerScenario $budgetMs "$expectedCount" "$regex" "$@"
+    if [ $count -ne $expectedCount ]; then
+        echo "$out" | head -20
+        echo -e " ${RED}FAIL:${NC} expected $expectedCount lines matching '$regex', received $count."
+        failedTests+=("'$name' (output)")
+    elif [ $bestMs -gt $budgetMs ]; then
+        echo -e " ${RED}FAIL:${NC} latency ${bestMs}ms ($((bestMs*100/calibrationMs))% of calibration) exceeds budget of ${budgetMs}ms."
+        failedTests+=("'$name' (latency ${bestMs}ms)")
+    else
+        echo -e " ${GREEN}OK${NC} (${bestMs}ms, $((bestMs*100/calibrationMs))% of calibration, budget ${budgetMs}ms)"
+    fi
+}
+
+# executes gwhisper up to the given number of times, until the output is not as
+# expected or a run stays within the budget. Sets out, count and bestMs.
+# 1. maximum number of runs
+# 2. latency budget in milliseconds (0: always execute all runs)
+# 3. expected number of output lines matching the regex
+# 4. regex
+# all other arguments are passed to gwhisper
+measureScenario() {
+    local runs=$1
+    local budgetMs=$2
+    local expectedCount=$3
+    local regex=$4
+    shift 4
+    bestMs=""
+    count=0
+    for run in $(seq $runs); do
+        local start=$(date +%s%N)
+        out=$("$gwhisper" "$@" 2>&1)
+        local end=$(date +%s%N)
+        local ms=$(((end-start)/1000000))
+        if [ -z "$bestMs" ] || [ $ms -lt $bestMs ]; then
+            bestMs=$ms
+        fi
+        count=$(echo "$out" | grep -c -E "$regex")
+        if [ $count -ne $expectedCount ] || [ $bestMs -le $budgetMs ]; then
+            break
+        fi
+    done
+}
+
+service=stress.StressService019
+method=stressMethod0099
+# deepest message nesting gWhisper builds grammar for:
+deepPath="nested=:$(printf 'child=:%.0s' $(seq 8))"
+deepClose=$(printf ':%.0s' $(seq 9))
+
+# calibration scenario, the budgets of all other scenarios are relative to it:
+((numTests=numTests+1))
+echo "#################################################################"
+echo "Executing calibration scenario 'complete services'"
+measureScenario $runsForCalibration 0 20 "^stress\.StressService[0-9]{3}$" --complete "$server "
+calibrationMs=$bestMs
+if [ $count -ne 20 ]; then
+    echo "$out" | head -20
+    echo -e " ${RED}FAIL:${NC} expected 20 services, received $count."
+    failedTests+=("'complete services' (output)")
+elif [ $calibrationMs -lt 1 ]; then
+    calibrationMs=1
+fi
+echo " calibration: ${calibrationMs}ms"
+
+# measured in percent of the calibration (highest of five runs): 135%, 287%, 331%, 193%
+runScenario "complete methods" 300 100 "^stressMethod[0-9]{4}$" --complete $server $service ""
+runScenario "complete fields" 430 200 "^field_[0-9]{4}=" --complete $server $service $method "f"
+runScenario "complete enum values" 500 2000 "^BIG_ENUM_VALUE_[0-9]{4} " --complete $server $service $method "choice="
+runScenario "complete enum value prefix" 300 100 "^BIG_ENUM_VALUE_19[0-9]{2} " --complete $server $service $method "choice=BIG_ENUM_VALUE_19"
+# measured: 276%, 181%
+runScenario "complete fields limited" 410 10 "^field_[0-9]{4}=" --completeLimit=10 --complete $server $service $method "f"
+runScenario "complete enum values limited" 300 10 "^BIG_ENUM_VALUE_[0-9]{4} " --completeLimit=10 --complete $server $service $method "choice="
+# measured: 218%, 1100%, 200%
+runScenario "complete deeply nested field" 330 1 "^child= +\(message\)$" --complete $server $service $method "${deepPath}c"
+runScenario "complete deeply nested enum" 1650 2000 "^BIG_ENUM_VALUE_[0-9]{4} " --complete $server $service $method "${deepPath}choice="
+runScenario "complete at max recursion depth" 300 1 "^child=MaxRecursionDepthExceeded " --complete $server $service $method "${deepPath}child=:c"
+# measured: 206%, 187%
+runScenario "complete deeply nested field limited" 310 1 "^child= +\(message\)$" --completeLimit=10 --complete $server $service $method "${deepPath}c"
+runScenario "complete deeply nested enum limited" 300 10 "^BIG_ENUM_VALUE_[0-9]{4} " --completeLimit=10 --complete $server $service $method "${deepPath}choice="
+# measured: 512%, 518%
+runScenario "parse and call deeply nested" 770 1 "^RPC succeeded" $server $service $method choice=BIG_ENUM_VALUE_1999 field_0005=-7 "${deepPath}choice=BIG_ENUM_VALUE_0042 text=deep${deepClose}"
+runScenario "echo deeply nested" 780 1 "choice = BIG_ENUM_VALUE_0042" $server $service $method choice=BIG_ENUM_VALUE_1999 field_0005=-7 "${deepPath}choice=BIG_ENUM_VALUE_0042 text=deep${deepClose}"
+
+# analyze test result:
+echo "#################################################################"
+echo "#################################################################"
+numFailed=${#failedTests[@]}
+numSucceeded=$((numTests-numFailed))
+echo "$numTests tests finished. Successful: $numSucceeded, Failed: $numFailed"
+rc=0
+if [ ${#failedTests[@]} -ne 0 ]; then
+    echo -e "The following tests failed:"
+    printf ' %s\n' "${failedTests[@]}"
+    echo -e "${RED}$numFailed TESTS FAILED${NC}"
+    rc=1
+else
+    echo -e "${GREEN}ALL $numTests TESTS SUCCEEDED${NC}"
+fi
+
+# stopping stress server
+echo "Stopping Server..."
+kill $serverPID
+rm -f $socket
+
+# return test result
+exit $rc
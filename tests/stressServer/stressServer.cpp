@@ -0,0 +1,123 @@
+// Copyright 2019 IBM Corporation
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+// A gRPC server registering all services of the generated stress schema
+// (see generateStressProto.cpp). Services and methods are registered by
+// iterating the schema's descriptors, every unary method echoes its request.
+
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <grpcpp/grpcpp.h>
+#include <grpcpp/impl/codegen/method_handler.h>
+#include <grpcpp/impl/codegen/rpc_service_method.h>
+#include <grpcpp/impl/codegen/service_type.h>
+#include "stress.pb.h"
+
+/// A service registering all unary methods of a service descriptor with a
+/// handler which replies with the unmodified request.
+class EchoService : public grpc::Service
+{
+    public:
+        explicit EchoService(const google::protobuf::ServiceDescriptor * f_service)
+        {
+            for(int i = 0; i < f_service->method_count(); i++)
+            {
+                const google::protobuf::MethodDescriptor * method = f_service->method(i);
+                if(method->client_streaming() or method->server_streaming())
+                {
+                    std::cout << "Skipping streaming method " << method->full_name() << std::endl;
+                    continue;
+                }
+                // RpcServiceMethod only keeps a pointer to the name:
+                m_methodPaths.push_back("/" + f_service->full_name() + "/" + method->name());
+                AddMethod(new grpc::internal::RpcServiceMethod(
+                    m_methodPaths.back().c_str(),
+                    grpc::internal::RpcMethod::NORMAL_RPC,
+                    new grpc::internal::RpcMethodHandler<EchoService, grpc::ByteBuffer, grpc::ByteBuffer>(
+                        [](EchoService * f_this, grpc::ServerContext * f_context, const grpc::ByteBuffer * f_request, grpc::ByteBuffer * f_reply)
+                        {
+                            return f_this->echo(f_context, f_request, f_reply);
+                        },
+                        this)));
+            }
+        }
+
+    private:
+        grpc::Status echo(grpc::ServerContext * f_context, const grpc::ByteBuffer * f_request, grpc::ByteBuffer * f_reply)
+        {
+            *f_reply = *f_request;
+            return grpc::Status::OK;
+        }
+
+        std::deque<std::string> m_methodPaths;
+};
+
+int main(int argc, char **argv)
+{
+    if(argc >= 2 and (std::string(argv[1]) == "-h" or std::string(argv[1]) == "--help"))
+    {
+        std::cout << "A gRPC server exposing the generated large stress schema with echo semantics." << std::endl << std::endl;
+        std::cout << "SYNOPSIS:" << std::endl;
+        std::cout << "stressServer [PORT|ADDRESS]" << std::endl << std::endl;
+        std::cout << "PORT:" << std::endl;
+        std::cout << "  The TCP port the server should listen to." << std::endl;
+        std::cout << "  Default: 50053" << std::endl << std::endl;
+        std::cout << "ADDRESS:" << std::endl;
+        std::cout << "  A gRPC listening address containing ':', e.g. unix:/tmp/stressServer.sock" << std::endl;
+        return 0;
+    }
+    std::string addr = "0.0.0.0:50053";
+    if(argc >=2)
+    {
+        std::string arg = argv[1];
+        if(arg.find(':') != std::string::npos)
+        {
+            addr = arg;
+        }
+        else
+        {
+            addr = "0.0.0.0:" + arg;
+        }
+    }
+    std::cout << "Starting server listening on " << addr << std::endl;
+    grpc::ServerBuilder builder;
+    builder.AddListeningPort(addr, grpc::InsecureServerCredentials());
+
+    // register all services of the generated schema:
+    const google::protobuf::FileDescriptor * file = stress::StressRequest::descriptor()->file();
+    std::vector<std::unique_ptr<EchoService>> services;
+    for(int i = 0; i < file->service_count(); i++)
+    {
+        services.emplace_back(new EchoService(file->service(i)));
+        builder.RegisterService(services.back().get());
+    }
+    std::cout << "Registered " << services.size() << " services." << std::endl;
+
+    std::unique_ptr<grpc::Server> server(builder.BuildAndStart());
+    if(server != nullptr)
+    {
+        server->Wait();
+    }
+    else
+    {
+        std::cout << "Server failed to start. exiting." << std::endl;
+        return -1;
+    }
+    return 0;
+}
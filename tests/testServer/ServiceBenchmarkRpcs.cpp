@@ -0,0 +1,78 @@
+// Copyright 2019 IBM Corporation
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "ServiceBenchmarkRpcs.hpp"
+
+::grpc::Status ServiceBenchmarkRpcs::echoPayload(
+        ::grpc::ServerContext* context,
+        const ::examples::Payload* request,
+        ::examples::Payload* response
+        )
+{
+    *response = *request;
+    return grpc::Status();
+}
+
+::grpc::Status ServiceBenchmarkRpcs::replyStreamFlood(
+        ::grpc::ServerContext* context,
+        const ::examples::FloodRequest* request,
+        ::grpc::ServerWriter< ::examples::Payload>* writer
+        )
+{
+    ::examples::Payload payload;
+    std::string * data = payload.mutable_data();
+    data->resize(request->payload_size());
+    for(size_t i = 0; i < data->size(); i++)
+    {
+        (*data)[i] = static_cast<char>(i);
+    }
+
+    bool ok = true;
+    uint32_t count = 0;
+    while((count < request->count()) and ok)
+    {
+        payload.set_sequence_number(count);
+        ok = writer->Write(payload);
+        count++;
+    }
+    return grpc::Status();
+}
+
+::grpc::Status ServiceBenchmarkRpcs::requestStreamFlood(
+        ::grpc::ServerContext* context,
+        ::grpc::ServerReader< ::examples::Payload>* reader,
+        ::examples::FloodSummary* response
+        )
+{
+    ::examples::Payload message;
+    while (reader->Read(&message)) {
+        response->set_message_count(response->message_count() + 1);
+        response->set_byte_count(response->byte_count() + message.data().size());
+    }
+    return grpc::Status();
+}
+
+::grpc::Status ServiceBenchmarkRpcs::bidirectionalStreamEchoPayload(
+            ::grpc::ServerContext* context,
+            ::grpc::ServerReaderWriter< ::examples::Payload,
+            ::examples::Payload>* stream
+            )
+{
+    ::examples::Payload message;
+    while (stream->Read(&message)) {
+        stream->Write(message);
+    }
+    return grpc::Status();
+}
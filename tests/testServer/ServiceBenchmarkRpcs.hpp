@@ -0,0 +1,45 @@
+// Copyright 2019 IBM Corporation
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#pragma once
+
+#include "examples.grpc.pb.h"
+
+class ServiceBenchmarkRpcs final : public examples::BenchmarkRpcs::Service
+{
+    virtual  ::grpc::Status echoPayload(
+            ::grpc::ServerContext* context,
+            const ::examples::Payload* request,
+            ::examples::Payload* response
+            ) override;
+
+    virtual  ::grpc::Status replyStreamFlood(
+            ::grpc::ServerContext* context,
+            const ::examples::FloodRequest* request,
+            ::grpc::ServerWriter< ::examples::Payload>* writer
+            ) override;
+
+    virtual  ::grpc::Status requestStreamFlood(
+            ::grpc::ServerContext* context,
+            ::grpc::ServerReader< ::examples::Payload>* reader,
+            ::examples::FloodSummary* response
+            ) override;
+
+    virtual  ::grpc::Status bidirectionalStreamEchoPayload(
+            ::grpc::ServerContext* context,
+            ::grpc::ServerReaderWriter< ::examples::Payload,
+            ::examples::Payload>* stream
+            ) override;
+};
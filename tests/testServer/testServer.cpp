@@ -20,6 +20,7 @@
 #include "ServiceComplexTypeRpcs.hpp"
 #include "ServiceNestedTypeRpcs.hpp"
 #include "ServiceStatusHandling.hpp"
+#include "ServiceBenchmarkRpcs.hpp"
 
 
 int main(int argc, char **argv)
@@ -29,20 +30,30 @@ int main(int argc, char **argv)
     {
         std::cout << "A simple gRPC test server implementing RPCs using most of the proto3 language features." << std::endl << std::endl;
         std::cout << "SYNOPSIS:" << std::endl;
-        std::cout << "testServer [OPTIONS] [PORT]" << std::endl << std::endl;
+        std::cout << "testServer [OPTIONS] [PORT|ADDRESS]" << std::endl << std::endl;
         std::cout << "OPTIONS:" << std::endl;
         std::cout << "  -h" << std::endl;
         std::cout << "  --help" << std::endl;
         std::cout << "     Shows this help" << std::endl << std::endl;
         std::cout << "PORT:" << std::endl;
         std::cout << "  The TCP port the server should listen to." << std::endl;
-        std::cout << "  Default: 50051" << std::endl;
+        std::cout << "  Default: 50051" << std::endl << std::endl;
+        std::cout << "ADDRESS:" << std::endl;
+        std::cout << "  A gRPC listening address containing ':', e.g. unix:/tmp/testServer.sock" << std::endl;
         return 0;
     }
     std::string addr = "0.0.0.0:50051";
     if(argc >=2)
     {
-        addr = "0.0.0.0:" + std::string(argv[1]);
+        std::string arg = argv[1];
+        if(arg.find(':') != std::string::npos)
+        {
+            addr = arg;
+        }
+        else
+        {
+            addr = "0.0.0.0:" + arg;
+        }
     }
     std::cout << "Starting server listening on " << addr << std::endl;
     grpc::ServerBuilder builder;
@@ -64,6 +75,9 @@ int main(int argc, char **argv)
     ServiceStatusHandling statusHandling;
     builder.RegisterService(&statusHandling);
 
+    ServiceBenchmarkRpcs benchmarkRpcs;
+    builder.RegisterService(&benchmarkRpcs);
+
 
     std::unique_ptr<grpc::Server> server(builder.BuildAndStart());
     if(server != nullptr)
@@ -404,3 +404,67 @@ TEST(AlternationTest, FixStringAndConcatinationAndOptionalChild) {
     EXPECT_NE(nullptr, parsedElement.getGrammarElement());
 
 }
+
+TEST(AlternationTest, NestedAlternationsParseEachLevelOnce) {
+    // level n: ("x:" level n-1) || "y", innermost: "ab" || "ac"
+    Grammar grammar;
+    auto innermostA = grammar.createElement<FixedString>("ab");
+    GrammarElement * level = grammar.createElement<Alternation>();
+    level->addChild(innermostA);
+    level->addChild(grammar.createElement<FixedString>("ac"));
+    const size_t depth = 12;
+    std::string input;
+    for(size_t i = 0; i < depth; i++)
+    {
+        auto concat = grammar.createElement<Concatenation>();
+        concat->addChild(grammar.createElement<FixedString>("x:"));
+        concat->addChild(level);
+        level = grammar.createElement<Alternation>();
+        level->addChild(concat);
+        level->addChild(grammar.createElement<FixedString>("y"));
+        input += "x:";
+    }
+    input += "a";
+
+    ParseProfiler::reset();
+    ParseProfiler::setEnabled(true);
+    ParsedElement parsedElement;
+    ParseRc rc = level->parse(input.c_str(), parsedElement);
+    ParseProfiler::setEnabled(false);
+
+    // rc:
+    EXPECT_EQ(ParseRc::ErrorType::missingText, rc.errorType);
+
+    // candidates:
+    ASSERT_EQ(2, rc.candidates.size());
+    EXPECT_EQ(input + "b", rc.candidates[0]->getMatchedString());
+    EXPECT_EQ(input + "c", rc.candidates[1]->getMatchedString());
+
+    // collecting candidates of a unique alternative does not parse it again,
+    // which would double the work with each level:
+    EXPECT_EQ(1, ParseProfiler::getStatistics()[innermostA->getInstanceId()].calls);
+}
+
+TEST(AlternationTest, CandidateLimitPrefersDocumentedCandidates) {
+    Grammar grammar;
+    auto alternation = grammar.createElement<Alternation>();
+    alternation->addChild(grammar.createElement<FixedString>("a1"));
+    alternation->addChild(grammar.createElement<FixedString>("a2"));
+    alternation->addChild(grammar.createElement<FixedString>("a3"));
+    auto documented = grammar.createElement<FixedString>("a4");
+    documented->setDocument("the documented one");
+    alternation->addChild(documented);
+
+    ParsedElement parsedElement;
+    // the limit allows two candidates (one more than the limit):
+    parsedElement.setCandidateLimit(1);
+    ParseRc rc = alternation->parse("a", parsedElement);
+
+    // rc:
+    EXPECT_EQ(ParseRc::ErrorType::missingText, rc.errorType);
+
+    // candidates keep their order:
+    ASSERT_EQ(2, rc.candidates.size());
+    EXPECT_EQ("a1", rc.candidates[0]->getMatchedString());
+    EXPECT_EQ("a4", rc.candidates[1]->getMatchedString());
+}
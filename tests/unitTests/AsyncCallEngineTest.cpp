@@ -0,0 +1,168 @@
+// Copyright 2019 IBM Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <gtest/gtest.h>
+#include <libCli/AsyncCallEngine.hpp>
+#include <grpcpp/alarm.h>
+#include <grpcpp/health_check_service_interface.h>
+#include <grpcpp/server_builder.h>
+
+#include <condition_variable>
+#include <mutex>
+#include <set>
+
+using namespace cli;
+
+// -----------------------------------------------------------------------------
+//          AsyncCallEngine
+// -----------------------------------------------------------------------------
+// Calls go to a non-existing server or to the default health check service of
+// an in-process server, so none of these tests need the test server.
+
+namespace
+{
+    /// Counts events and remembers the threads they were delivered on.
+    class CountingTag : public AsyncCallEngine::Tag
+    {
+        public:
+            CountingTag(std::mutex & f_mutex, std::condition_variable & f_cv, size_t & f_count, std::set<std::thread::id> & f_threads) :
+                m_mutex(f_mutex),
+                m_cv(f_cv),
+                m_count(f_count),
+                m_threads(f_threads)
+            {
+            }
+
+            void proceed(bool f_ok) override
+            {
+                EXPECT_TRUE(f_ok);
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_count++;
+                m_threads.insert(std::this_thread::get_id());
+                m_cv.notify_one();
+            }
+
+            grpc::Alarm m_alarm;
+
+        private:
+            std::mutex & m_mutex;
+            std::condition_variable & m_cv;
+            size_t & m_count;
+            std::set<std::thread::id> & m_threads;
+    };
+}
+
+TEST(AsyncCallEngineTest, TagsAreProceededOnPollerThreads) {
+    const size_t numTags = 200;
+    std::mutex mutex;
+    std::condition_variable cv;
+    size_t count = 0;
+    std::set<std::thread::id> threads;
+    std::vector<std::unique_ptr<CountingTag>> tags;
+
+    AsyncCallEngine engine(4);
+    EXPECT_EQ(4u, engine.getNumPollers());
+    for(size_t i = 0; i < numTags; i++)
+    {
+        tags.emplace_back(new CountingTag(mutex, cv, count, threads));
+        tags.back()->m_alarm.Set(engine.getCompletionQueue(), std::chrono::system_clock::now(), tags.back().get());
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    ASSERT_TRUE(cv.wait_for(lock, std::chrono::seconds(10), [&]() { return count == numTags; }));
+    EXPECT_EQ(0u, threads.count(std::this_thread::get_id()));
+    EXPECT_LE(threads.size(), 4u);
+}
+
+TEST(AsyncCallEngineTest, ManyConcurrentUnaryCallsComplete) {
+    const size_t numCalls = 1000;
+    std::shared_ptr<grpc::Channel> channel = grpc::CreateChannel("unix:/nonexistent/AsyncCallEngineTest.sock", grpc::InsecureChannelCredentials());
+    grpc::GenericStub stub(channel);
+    grpc::Slice slice(std::string(""));
+    grpc::ByteBuffer request(&slice, 1);
+    std::vector<std::unique_ptr<grpc::ClientContext>> contexts;
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    size_t numDone = 0;
+    size_t numOk = 0;
+
+    AsyncCallEngine engine(2);
+    for(size_t i = 0; i < numCalls; i++)
+    {
+        contexts.emplace_back(new grpc::ClientContext());
+        contexts.back()->set_deadline(std::chrono::system_clock::now() + std::chrono::milliseconds(100));
+        engine.startUnaryCall(stub, *contexts.back(), "/AsyncCallEngineTest/Method", request, [&](const grpc::Status & f_status, grpc::ByteBuffer &)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            numDone++;
+            if(f_status.ok())
+            {
+                numOk++;
+            }
+            cv.notify_one();
+        });
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    ASSERT_TRUE(cv.wait_for(lock, std::chrono::seconds(10), [&]() { return numDone == numCalls; }));
+    EXPECT_EQ(0u, numOk);
+}
+
+TEST(AsyncCallEngineTest, CallbackMayDestroyContextOfSuccessfulCall) {
+    const size_t numCalls = 1000;
+    grpc::EnableDefaultHealthCheckService(true);
+    grpc::ServerBuilder builder;
+    std::unique_ptr<grpc::Server> server = builder.BuildAndStart();
+    ASSERT_NE(nullptr, server);
+    grpc::GenericStub stub(server->InProcessChannel(grpc::ChannelArguments()));
+    // An empty HealthCheckRequest asks for the overall server health:
+    grpc::Slice slice(std::string(""));
+    grpc::ByteBuffer request(&slice, 1);
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    size_t numDone = 0;
+    size_t numOk = 0;
+
+    AsyncCallEngine engine(4);
+    for(size_t i = 0; i < numCalls; i++)
+    {
+        grpc::ClientContext * context = new grpc::ClientContext();
+        context->set_deadline(std::chrono::system_clock::now() + std::chrono::seconds(10));
+        engine.startUnaryCall(stub, *context, "/grpc.health.v1.Health/Check", request, [&, context](const grpc::Status & f_status, grpc::ByteBuffer & f_reply)
+        {
+            // like a fan-out call releasing its host, this frees the arena
+            // the call's reader was allocated in:
+            delete context;
+            std::vector<grpc::Slice> slices;
+            bool replyOk = f_reply.Dump(&slices).ok();
+            std::lock_guard<std::mutex> lock(mutex);
+            numDone++;
+            if(f_status.ok() and replyOk)
+            {
+                numOk++;
+            }
+            cv.notify_one();
+        });
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        ASSERT_TRUE(cv.wait_for(lock, std::chrono::seconds(20), [&]() { return numDone == numCalls; }));
+        EXPECT_EQ(numCalls, numOk);
+    }
+    server->Shutdown();
+}
@@ -0,0 +1,189 @@
+// Copyright 2019 IBM Corporation
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+#include <libCli/ConnectionManager.hpp>
+
+#include <chrono>
+#include <thread>
+
+using namespace cli;
+
+// -----------------------------------------------------------------------------
+//          ConnectionManager
+// -----------------------------------------------------------------------------
+// Channels are created lazily by gRPC, so none of these tests need a server.
+
+TEST(ConnectionManagerTest, SameAddressReusesConnection) {
+    ConnectionManager & manager = ConnectionManager::getInstance();
+    const std::string address = "unix:/nonexistent/ConnectionManagerTest_reuse.sock";
+
+    std::shared_ptr<grpc::Channel> channel = manager.getChannel(address);
+    ASSERT_NE(nullptr, channel);
+    EXPECT_EQ(channel, manager.getChannel(address));
+
+    const ConnList & connection = manager.getConnection(address);
+    EXPECT_EQ(channel, connection.channel);
+    EXPECT_EQ(connection.descDb, manager.getDescDb(address));
+    EXPECT_EQ(connection.descPool, manager.getDescPool(address));
+    EXPECT_NE(nullptr, connection.descDb);
+    EXPECT_NE(nullptr, connection.descPool);
+}
+
+TEST(ConnectionManagerTest, DifferentAddressesHaveDifferentConnections) {
+    ConnectionManager & manager = ConnectionManager::getInstance();
+
+    const ConnList & connectionA = manager.getConnection("unix:/nonexistent/ConnectionManagerTest_a.sock");
+    const ConnList & connectionB = manager.getConnection("unix:/nonexistent/ConnectionManagerTest_b.sock");
+    EXPECT_NE(connectionA.channel, connectionB.channel);
+    EXPECT_NE(connectionA.descDb, connectionB.descDb);
+    EXPECT_NE(connectionA.descPool, connectionB.descPool);
+}
+
+TEST(ConnectionManagerTest, ConcurrentFirstAccessCreatesOneConnection) {
+    ConnectionManager & manager = ConnectionManager::getInstance();
+    const size_t numThreads = 16;
+    const size_t numAddresses = 8;
+
+    std::vector<std::vector<const ConnList*>> results(numThreads, std::vector<const ConnList*>(numAddresses, nullptr));
+    std::vector<std::thread> threads;
+    for(size_t t = 0; t < numThreads; t++)
+    {
+        threads.emplace_back([&manager, &results, t, numAddresses]()
+            {
+                for(size_t a = 0; a < numAddresses; a++)
+                {
+                    results[t][a] = &manager.getConnection("unix:/nonexistent/ConnectionManagerTest_concurrent" + std::to_string(a) + ".sock");
+                }
+            });
+    }
+    for(auto & thread : threads)
+    {
+        thread.join();
+    }
+
+    for(size_t a = 0; a < numAddresses; a++)
+    {
+        ASSERT_NE(nullptr, results[0][a]->channel);
+        for(size_t t = 1; t < numThreads; t++)
+        {
+            EXPECT_EQ(results[0][a], results[t][a]);
+            EXPECT_EQ(results[0][a]->channel, results[t][a]->channel);
+            EXPECT_EQ(results[0][a]->descDb, results[t][a]->descDb);
+        }
+    }
+}
+
+TEST(ConnectionManagerTest, PrewarmUnreachableServersInParallel) {
+    ConnectionManager & manager = ConnectionManager::getInstance();
+    std::vector<std::string> addresses;
+    for(size_t i = 0; i < 4; i++)
+    {
+        addresses.push_back("unix:/nonexistent/ConnectionManagerTest_prewarm" + std::to_string(i) + ".sock");
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<bool> result = manager.prewarm(addresses, 300);
+    auto duration = std::chrono::steady_clock::now() - start;
+
+    ASSERT_EQ(addresses.size(), result.size());
+    for(size_t i = 0; i < addresses.size(); i++)
+    {
+        EXPECT_FALSE(result[i]);
+        // prewarm registers the connections:
+        EXPECT_NE(nullptr, manager.getChannel(addresses[i]));
+    }
+    // servers are contacted in parallel, not one after another:
+    EXPECT_LT(std::chrono::duration_cast<std::chrono::milliseconds>(duration).count(), 4 * 300);
+}
+
+TEST(ConnectionManagerTest, ChannelPoolRoundRobin) {
+    ConnectionManager & manager = ConnectionManager::getInstance();
+    const std::string address = "unix:/nonexistent/ConnectionManagerTest_poolRoundRobin.sock";
+
+    std::vector<std::shared_ptr<grpc::Channel>> channels;
+    for(size_t i = 0; i < 6; i++)
+    {
+        ChannelLease lease = manager.acquireChannel(address, 3, ChannelSelection::RoundRobin);
+        channels.push_back(lease.getChannel());
+    }
+
+    // the first pool channel is the channel used for reflection:
+    EXPECT_EQ(manager.getChannel(address), channels[0]);
+    EXPECT_NE(channels[0], channels[1]);
+    EXPECT_NE(channels[1], channels[2]);
+    EXPECT_NE(channels[0], channels[2]);
+    for(size_t i = 0; i < 3; i++)
+    {
+        EXPECT_EQ(channels[i], channels[i+3]);
+    }
+}
+
+TEST(ConnectionManagerTest, ChannelPoolLeastOutstanding) {
+    ConnectionManager & manager = ConnectionManager::getInstance();
+    const std::string address = "unix:/nonexistent/ConnectionManagerTest_poolLeastOutstanding.sock";
+
+    ChannelLease leaseA = manager.acquireChannel(address, 2, ChannelSelection::LeastOutstanding);
+    ChannelLease leaseB = manager.acquireChannel(address, 2, ChannelSelection::LeastOutstanding);
+    EXPECT_NE(leaseA.getChannel(), leaseB.getChannel());
+
+    std::shared_ptr<grpc::Channel> channelB = leaseB.getChannel();
+    {
+        // while A and B are in use, both channels have one outstanding call
+        // and B's channel is not preferred:
+        ChannelLease leaseC = manager.acquireChannel(address, 2, ChannelSelection::LeastOutstanding);
+        ChannelLease leaseD = manager.acquireChannel(address, 2, ChannelSelection::LeastOutstanding);
+        EXPECT_NE(leaseC.getChannel(), leaseD.getChannel());
+    }
+    {
+        // release A, its channel is now the least loaded one, independent of
+        // the round robin position:
+        ChannelLease released(std::move(leaseA));
+    }
+    for(size_t i = 0; i < 3; i++)
+    {
+        ChannelLease lease = manager.acquireChannel(address, 2, ChannelSelection::LeastOutstanding);
+        EXPECT_NE(channelB, lease.getChannel());
+    }
+}
+
+TEST(ConnectionManagerTest, ChannelOptionsArePartOfTheCacheKey) {
+    ConnectionManager & manager = ConnectionManager::getInstance();
+    const std::string address = "unix:/nonexistent/ConnectionManagerTest_options.sock";
+
+    ChannelOptions defaultOptions;
+    EXPECT_EQ("", defaultOptions.getKey());
+    EXPECT_EQ(manager.getChannel(address), manager.getChannel(address, defaultOptions));
+
+    ChannelOptions largeReplies;
+    largeReplies.maxReceiveMessageSize = 64 * 1024 * 1024;
+    ChannelOptions gzip;
+    gzip.compression = "gzip";
+    EXPECT_NE(largeReplies.getKey(), gzip.getKey());
+
+    std::shared_ptr<grpc::Channel> largeRepliesChannel = manager.getChannel(address, largeReplies);
+    std::shared_ptr<grpc::Channel> gzipChannel = manager.getChannel(address, gzip);
+    EXPECT_NE(manager.getChannel(address), largeRepliesChannel);
+    EXPECT_NE(manager.getChannel(address), gzipChannel);
+    EXPECT_NE(largeRepliesChannel, gzipChannel);
+
+    // equal options share the channel:
+    ChannelOptions gzipAgain;
+    gzipAgain.compression = "gzip";
+    EXPECT_EQ(gzipChannel, manager.getChannel(address, gzipAgain));
+
+    // the channel pool is tuned as well:
+    ChannelLease lease = manager.acquireChannel(address, 1, ChannelSelection::RoundRobin, gzip);
+    EXPECT_EQ(gzipChannel, lease.getChannel());
+}
@@ -0,0 +1,254 @@
+// Copyright 2019 IBM Corporation
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <gtest/gtest.h>
+#include <libArgParse/ArgParse.hpp>
+
+using namespace ArgParse;
+
+// -----------------------------------------------------------------------------
+//          IncrementalParser
+// -----------------------------------------------------------------------------
+
+namespace
+{
+    /// options, a word, a choice and key=value pairs, all whitespace separated
+    GrammarElement * createTestGrammar(Grammar & f_grammar)
+    {
+        auto option = f_grammar.createElement<Alternation>();
+        option->addChild(f_grammar.createElement<FixedString>("--x", "OptionX"));
+        option->addChild(f_grammar.createElement<FixedString>("--yy", "OptionY"));
+        auto optionConcat = f_grammar.createElement<Concatenation>();
+        optionConcat->addChild(option);
+        optionConcat->addChild(f_grammar.createElement<WhiteSpace>());
+        auto options = f_grammar.createElement<Repetition>();
+        options->addChild(optionConcat);
+
+        auto choice = f_grammar.createElement<Alternation>("Choice");
+        choice->addChild(f_grammar.createElement<FixedString>("alpha"));
+        choice->addChild(f_grammar.createElement<FixedString>("beta"));
+        choice->addChild(f_grammar.createElement<FixedString>("betamax"));
+
+        auto pair = f_grammar.createElement<Concatenation>("Pair");
+        pair->addChild(f_grammar.createElement<WhiteSpace>());
+        auto key = f_grammar.createElement<Alternation>("Key");
+        key->addChild(f_grammar.createElement<FixedString>("key"));
+        key->addChild(f_grammar.createElement<FixedString>("kind"));
+        pair->addChild(key);
+        pair->addChild(f_grammar.createElement<FixedString>("="));
+        pair->addChild(f_grammar.createElement<RegEx>("[0-9]+", "Value"));
+        auto pairs = f_grammar.createElement<Repetition>();
+        pairs->addChild(pair);
+
+        auto root = f_grammar.createElement<Concatenation>();
+        root->addChild(options);
+        root->addChild(f_grammar.createElement<RegEx>("[a-z]+", "Word"));
+        root->addChild(f_grammar.createElement<WhiteSpace>());
+        root->addChild(choice);
+        root->addChild(pairs);
+        return root;
+    }
+
+    /// injects a list of key=value pairs and nested lists, like method arguments
+    class ArgsInjector : public GrammarInjector
+    {
+        public:
+            explicit ArgsInjector(Grammar & f_grammar) :
+                GrammarInjector("Args", "Args"),
+                m_grammar(f_grammar)
+            {
+            }
+
+            virtual GrammarElement * getGrammar(ParsedElement * f_parseTree, std::string & f_ErrorMessage) override
+            {
+                return createArgList(":");
+            }
+
+        private:
+            GrammarElement * createArgList(const std::string & f_delimiter)
+            {
+                GrammarFactory grammarFactory(m_grammar);
+                auto fields = m_grammar.createElement<Alternation>();
+                auto list = grammarFactory.createList("Message", fields, m_grammar.createElement<WhiteSpace>(), false);
+                for(const std::string & key : {"key", "kind"})
+                {
+                    auto field = m_grammar.createElement<Concatenation>("Field");
+                    field->addChild(m_grammar.createElement<FixedString>(key + "="));
+                    field->addChild(m_grammar.createElement<RegEx>("[0-9]+", "Value"));
+                    fields->addChild(field);
+                }
+                if(f_delimiter != "")
+                {
+                    auto sub = m_grammar.createElement<Concatenation>("Field");
+                    sub->addChild(m_grammar.createElement<FixedString>("sub=" + f_delimiter));
+                    sub->addChild(createArgList(""));
+                    sub->addChild(m_grammar.createElement<FixedString>(f_delimiter));
+                    fields->addChild(sub);
+                }
+                return list;
+            }
+
+            Grammar & m_grammar;
+    };
+
+    /// a word followed by optional arguments from a GrammarInjector (like the gWhisper grammar)
+    GrammarElement * createNestedTestGrammar(Grammar & f_grammar)
+    {
+        auto args = f_grammar.createElement<Concatenation>();
+        args->addChild(f_grammar.createElement<WhiteSpace>());
+        args->addChild(f_grammar.createElement<ArgsInjector>(f_grammar));
+        auto optionalArgs = f_grammar.createElement<Optional>();
+        optionalArgs->addChild(args);
+
+        auto root = f_grammar.createElement<Concatenation>();
+        root->addChild(f_grammar.createElement<RegEx>("[a-z]+", "Word"));
+        root->addChild(optionalArgs);
+        return root;
+    }
+
+    std::string getCandidatesString(const ParseRc & f_rc)
+    {
+        std::string result;
+        for(auto candidate : f_rc.candidates)
+        {
+            result += "'" + candidate->getMatchedStringRaw() + "' ";
+        }
+        return result;
+    }
+
+    void expectSameResult(GrammarElement * f_grammarRoot, IncrementalParser & f_parser, const std::string & f_input)
+    {
+        ParsedElement expectedTree;
+        ParseRc expectedRc = f_grammarRoot->parse(f_input.c_str(), expectedTree);
+        ParsedElement parseTree;
+        ParseRc rc = f_parser.parse(f_input, parseTree);
+
+        EXPECT_EQ(expectedRc.errorType, rc.errorType) << "input: '" << f_input << "'";
+        EXPECT_EQ(expectedRc.lenParsed, rc.lenParsed) << "input: '" << f_input << "'";
+        EXPECT_EQ(expectedRc.lenParsedSuccessfully, rc.lenParsedSuccessfully) << "input: '" << f_input << "'";
+        EXPECT_EQ(expectedTree.getMatchedStringRaw(), parseTree.getMatchedStringRaw()) << "input: '" << f_input << "'";
+        EXPECT_EQ(expectedTree.findFirstChild("Choice"), parseTree.findFirstChild("Choice")) << "input: '" << f_input << "'";
+        EXPECT_EQ(getCandidatesString(expectedRc), getCandidatesString(rc)) << "input: '" << f_input << "'";
+    }
+}
+
+TEST(IncrementalParserTest, TypingGivesSameResultAsFullParse) {
+    Grammar grammar;
+    GrammarElement * root = createTestGrammar(grammar);
+    IncrementalParser parser(root);
+
+    const std::string input = "--x --yy word beta key=1 kind=22 key=333";
+    for(size_t i = 0; i <= input.size(); i++)
+    {
+        expectSameResult(root, parser, input.substr(0, i));
+    }
+    // only the last pair was parsed again:
+    EXPECT_EQ(std::string("--x --yy word beta key=1 kind=22").size(), parser.getReusedLength());
+}
+
+TEST(IncrementalParserTest, TypingNestedArgumentsGivesSameResultAsFullParse) {
+    Grammar grammar;
+    GrammarElement * root = createNestedTestGrammar(grammar);
+    IncrementalParser parser(root);
+
+    const std::string input = "word key=1 sub=:kind=2 key=3: kind=44 key=5";
+    for(size_t i = 0; i <= input.size(); i++)
+    {
+        expectSameResult(root, parser, input.substr(0, i));
+    }
+    // the arguments are continued, only the last one is parsed again:
+    expectSameResult(root, parser, input + "6");
+    EXPECT_EQ(std::string("word key=1 sub=:kind=2 key=3: kind=44").size(), parser.getReusedLength());
+
+    expectSameResult(root, parser, "word key=1 sub=:kind=2 key=3: kind=44 key=5 ");
+    expectSameResult(root, parser, "word key=1 sub=:kind=2 key=3: kind=44 k");
+    expectSameResult(root, parser, "word key=1 sub=:kind=2 ke");
+    expectSameResult(root, parser, "word key=1 sub=:kind=2 key=3: kind=44 x");
+    expectSameResult(root, parser, "word key=1 sub=:kind=2 key=3: kind=44 key=5");
+    expectSameResult(root, parser, "word key=1 ");
+    expectSameResult(root, parser, "word");
+}
+
+TEST(IncrementalParserTest, ContinuedChildrenBelongToNewParseTree) {
+    Grammar grammar;
+    GrammarElement * root = createNestedTestGrammar(grammar);
+    IncrementalParser parser(root);
+
+    std::unique_ptr<ParsedElement> previousTree(new ParsedElement());
+    parser.parse("word key=1 kind=2 key=3", *previousTree);
+    ParsedElement parseTree;
+    parser.parse("word key=1 kind=2 key=34", parseTree);
+    ASSERT_EQ(std::string("word key=1 kind=2").size(), parser.getReusedLength());
+    previousTree.reset();
+
+    std::vector<ParsedElement*> fields;
+    parseTree.findAllSubTrees("Field", fields);
+    ASSERT_EQ(3u, fields.size());
+    for(auto field : fields)
+    {
+        EXPECT_EQ(&parseTree, field->getRoot());
+    }
+    EXPECT_EQ("key=34", fields[2]->getMatchedString());
+}
+
+TEST(IncrementalParserTest, EditingGivesSameResultAsFullParse) {
+    Grammar grammar;
+    GrammarElement * root = createTestGrammar(grammar);
+    IncrementalParser parser(root);
+
+    expectSameResult(root, parser, "--x word beta key=1");
+    // extending a token, which changes the choice:
+    expectSameResult(root, parser, "--x word betamax key=1");
+    // deleting:
+    expectSameResult(root, parser, "--x word bet");
+    // changing an earlier token:
+    expectSameResult(root, parser, "--yy word bet");
+    EXPECT_EQ(0, parser.getReusedLength());
+    expectSameResult(root, parser, "--yy other beta ");
+    expectSameResult(root, parser, "");
+}
+
+TEST(IncrementalParserTest, ReusedChildrenBelongToNewParseTree) {
+    Grammar grammar;
+    GrammarElement * root = createTestGrammar(grammar);
+    IncrementalParser parser(root);
+
+    std::unique_ptr<ParsedElement> previousTree(new ParsedElement());
+    parser.parse("--x word beta key=1", *previousTree);
+    ParsedElement parseTree;
+    parser.parse("--x word beta key=12", parseTree);
+    ASSERT_LT(0u, parser.getReusedLength());
+    previousTree.reset();
+
+    for(auto child : parseTree.getChildren())
+    {
+        EXPECT_EQ(&parseTree, child->getParent());
+    }
+    bool found = false;
+    ParsedElement & word = parseTree.findFirstSubTree("Word", found);
+    ASSERT_TRUE(found);
+    EXPECT_EQ(&parseTree, word.getRoot());
+}
+
+TEST(IncrementalParserTest, ResetForgetsPreviousParse) {
+    Grammar grammar;
+    GrammarElement * root = createTestGrammar(grammar);
+    IncrementalParser parser(root);
+
+    expectSameResult(root, parser, "--x word beta key=1");
+    parser.reset();
+    expectSameResult(root, parser, "--x word beta key=12");
+    EXPECT_EQ(0, parser.getReusedLength());
+}
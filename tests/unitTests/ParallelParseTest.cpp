@@ -0,0 +1,171 @@
+// Copyright 2019 IBM Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <gtest/gtest.h>
+#include <libArgParse/ArgParse.hpp>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using namespace ArgParse;
+
+// -----------------------------------------------------------------------------
+//          Parsing a frozen grammar from multiple threads
+// -----------------------------------------------------------------------------
+
+namespace
+{
+    /// Injects "fooA" / "fooB" slowly and counts the injections.
+    class CountingInjector : public GrammarInjector
+    {
+        public:
+            explicit CountingInjector(Grammar & f_grammar) :
+                GrammarInjector("Counting"),
+                m_grammar(f_grammar),
+                m_numInjections(0)
+            {
+            }
+
+            virtual GrammarElement * getGrammar(ParsedElement * f_parseTree, std::string & f_ErrorMessage) override
+            {
+                m_numInjections++;
+                std::this_thread::sleep_for(std::chrono::milliseconds(20));
+                auto result = m_grammar.createElement<Alternation>();
+                result->addChild(m_grammar.createElement<FixedString>("fooA", "Injected"));
+                result->addChild(m_grammar.createElement<FixedString>("fooB", "Injected"));
+                return result;
+            }
+
+            int getNumInjections() const
+            {
+                return m_numInjections.load();
+            }
+
+        private:
+            Grammar & m_grammar;
+            std::atomic<int> m_numInjections;
+    };
+
+    const size_t s_numThreads = 8;
+}
+
+TEST(ParallelParseTest, FreezeMarksAllElements)
+{
+    Grammar grammar;
+    auto root = grammar.createElement<Concatenation>();
+    auto child = grammar.createElement<FixedString>("a");
+    root->addChild(child);
+    ASSERT_FALSE(root->isFrozen());
+
+    grammar.freeze();
+    EXPECT_TRUE(root->isFrozen());
+    EXPECT_TRUE(child->isFrozen());
+
+    // frozen elements may still be referenced by new elements:
+    auto newRoot = grammar.createElement<Alternation>();
+    newRoot->addChild(child);
+    EXPECT_FALSE(newRoot->isFrozen());
+    EXPECT_EQ(1u, newRoot->getChildren().size());
+}
+
+TEST(ParallelParseTest, InjectsOnceForConcurrentParses)
+{
+    Grammar grammar;
+    auto root = grammar.createElement<Concatenation>();
+    root->addChild(grammar.createElement<FixedString>("bar"));
+    root->addChild(grammar.createElement<WhiteSpace>());
+    auto injector = grammar.createElement<CountingInjector>(grammar);
+    root->addChild(injector);
+    grammar.freeze();
+
+    std::atomic<size_t> numOk(0);
+    std::vector<std::thread> threads;
+    for(size_t i = 0; i < s_numThreads; i++)
+    {
+        threads.emplace_back([&, i]()
+        {
+            std::string input = (i % 2 == 0) ? "bar fooA" : "bar fooB";
+            ParsedElement parseTree;
+            ParseRc rc = root->parse(input.c_str(), parseTree);
+            if(rc.isGood() and (parseTree.findFirstChild("Injected") == input.substr(4)))
+            {
+                numOk++;
+            }
+        });
+    }
+    for(auto & thread : threads)
+    {
+        thread.join();
+    }
+
+    EXPECT_EQ(s_numThreads, numOk.load());
+    EXPECT_EQ(1, injector->getNumInjections());
+    ASSERT_NE(nullptr, injector->getInjectedGrammar());
+    EXPECT_TRUE(injector->getInjectedGrammar()->isFrozen());
+    // the frozen injector itself is not changed by the injection:
+    EXPECT_TRUE(injector->getChildren().empty());
+    EXPECT_NE(std::string::npos, injector->getDotNode().find(" -> n" + std::to_string(injector->getInjectedGrammar()->getInstanceId()) + ";"));
+}
+
+TEST(ParallelParseTest, ConcurrentParsesGiveSameResultAsSequential)
+{
+    Grammar grammar;
+    auto key = grammar.createElement<Alternation>("Key");
+    key->addChild(grammar.createElement<FixedString>("key"));
+    key->addChild(grammar.createElement<FixedString>("kind"));
+    auto pair = grammar.createElement<Concatenation>();
+    pair->addChild(key);
+    pair->addChild(grammar.createElement<FixedString>("="));
+    pair->addChild(grammar.createElement<RegEx>("[0-9]+", "Value"));
+    pair->addChild(grammar.createElement<WhiteSpace>());
+    auto root = grammar.createElement<Repetition>();
+    root->addChild(pair);
+    grammar.freeze();
+
+    const std::vector<std::string> inputs = {"key=1 kind=22 ", "ki", "key=1 k", "kind=333 key=4444 "};
+    std::vector<std::string> expected;
+    for(auto & input : inputs)
+    {
+        ParsedElement parseTree;
+        ParseRc rc = root->parse(input.c_str(), parseTree);
+        expected.push_back(parseTree.getDebugString() + std::to_string(rc.candidates.size()));
+    }
+
+    std::atomic<size_t> numMismatches(0);
+    std::vector<std::thread> threads;
+    for(size_t i = 0; i < s_numThreads; i++)
+    {
+        threads.emplace_back([&]()
+        {
+            for(size_t run = 0; run < 200; run++)
+            {
+                size_t inputIndex = run % inputs.size();
+                ParsedElement parseTree;
+                ParseRc rc = root->parse(inputs[inputIndex].c_str(), parseTree);
+                if(parseTree.getDebugString() + std::to_string(rc.candidates.size()) != expected[inputIndex])
+                {
+                    numMismatches++;
+                }
+            }
+        });
+    }
+    for(auto & thread : threads)
+    {
+        thread.join();
+    }
+
+    EXPECT_EQ(0u, numMismatches.load());
+}
@@ -0,0 +1,83 @@
+// Copyright 2019 IBM Corporation
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <gtest/gtest.h>
+#include <libArgParse/ArgParse.hpp>
+
+using namespace ArgParse;
+
+// -----------------------------------------------------------------------------
+//          ParseProfiler
+// -----------------------------------------------------------------------------
+
+TEST(ParseProfilerTest, DisabledRecordsNothing) {
+    ParseProfiler::reset();
+
+    Grammar grammar;
+    auto concat = grammar.createElement<Concatenation>();
+    concat->addChild(grammar.createElement<FixedString>("a"));
+    concat->addChild(grammar.createElement<FixedString>("b"));
+
+    ParsedElement parsedElement;
+    ParseRc rc = concat->parse("ab", parsedElement);
+    EXPECT_EQ(ParseRc::ErrorType::success, rc.errorType);
+
+    EXPECT_EQ(0, ParseProfiler::getStatistics().size());
+}
+
+TEST(ParseProfilerTest, CountsCallsAndParsedElements) {
+    ParseProfiler::reset();
+
+    Grammar grammar;
+    auto concat = grammar.createElement<Concatenation>("Root");
+    auto childA = grammar.createElement<FixedString>("a");
+    auto childB = grammar.createElement<FixedString>("b");
+    concat->addChild(childA);
+    concat->addChild(childB);
+
+    ParseProfiler::setEnabled(true);
+    ParsedElement parsedElement;
+    ParseRc rc = concat->parse("ab", parsedElement);
+    ParseProfiler::setEnabled(false);
+    EXPECT_EQ(ParseRc::ErrorType::success, rc.errorType);
+
+    std::map<uint32_t, ParseProfiler::ElementStatistics> statistics = ParseProfiler::getStatistics();
+    ASSERT_EQ(1, statistics.count(concat->getInstanceId()));
+    ASSERT_EQ(1, statistics.count(childA->getInstanceId()));
+    ASSERT_EQ(1, statistics.count(childB->getInstanceId()));
+
+    const ParseProfiler::ElementStatistics & concatStats = statistics[concat->getInstanceId()];
+    EXPECT_LE(1, concatStats.calls);
+    EXPECT_LE(concatStats.selfTime, concatStats.totalTime);
+    // the concatenation creates the ParsedElements for its children:
+    EXPECT_LE(2, concatStats.parsedElements);
+
+    const ParseProfiler::ElementStatistics & childStats = statistics[childA->getInstanceId()];
+    EXPECT_LE(1, childStats.calls);
+    EXPECT_EQ(childStats.selfTime, childStats.totalTime);
+    EXPECT_EQ(0, childStats.parsedElements);
+    // children are included in the total time of the concatenation:
+    EXPECT_LE(childStats.totalTime, concatStats.totalTime);
+
+    // output:
+    std::string table = grammar.getProfileTable();
+    EXPECT_NE(std::string::npos, table.find("Concatenation"));
+    EXPECT_NE(std::string::npos, table.find("Root"));
+    EXPECT_NE(std::string::npos, table.find("FixedString"));
+    EXPECT_EQ(std::string::npos, grammar.getDotGraph().find("fillcolor"));
+    EXPECT_NE(std::string::npos, grammar.getDotGraph(true).find("n" + std::to_string(concat->getInstanceId()) + "[style=filled"));
+
+    ParseProfiler::reset();
+}
@@ -0,0 +1,134 @@
+// Copyright 2019 IBM Corporation
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <gtest/gtest.h>
+#include <libArgParse/ArgParse.hpp>
+
+using namespace ArgParse;
+
+// -----------------------------------------------------------------------------
+//          ParsedElement children sharing
+// -----------------------------------------------------------------------------
+
+TEST(ParsedElementTest, SharedChildrenAreNotCopied) {
+    ParsedElement original;
+    auto child1 = std::make_shared<ParsedElement>();
+    auto child2 = std::make_shared<ParsedElement>();
+    original.addChild(child1);
+    original.addChild(child2);
+
+    ParsedElement candidate;
+    candidate.shareChildren(original);
+    ASSERT_EQ(2, candidate.getChildren().size());
+    EXPECT_EQ(child1, candidate.getChildren()[0]);
+    EXPECT_EQ(child2, candidate.getChildren()[1]);
+}
+
+TEST(ParsedElementTest, AppendingAfterSharingIsNotVisibleToOthers) {
+    ParsedElement original;
+    auto child1 = std::make_shared<ParsedElement>();
+    original.addChild(child1);
+
+    ParsedElement candidateA;
+    candidateA.shareChildren(original);
+    ParsedElement candidateB;
+    candidateB.shareChildren(original);
+
+    auto childA = std::make_shared<ParsedElement>();
+    auto childB = std::make_shared<ParsedElement>();
+    auto child2 = std::make_shared<ParsedElement>();
+    candidateA.addChild(childA);
+    candidateB.addChild(childB);
+    original.addChild(child2);
+
+    ASSERT_EQ(2, original.getChildren().size());
+    EXPECT_EQ(child1, original.getChildren()[0]);
+    EXPECT_EQ(child2, original.getChildren()[1]);
+    ASSERT_EQ(2, candidateA.getChildren().size());
+    EXPECT_EQ(child1, candidateA.getChildren()[0]);
+    EXPECT_EQ(childA, candidateA.getChildren()[1]);
+    ASSERT_EQ(2, candidateB.getChildren().size());
+    EXPECT_EQ(child1, candidateB.getChildren()[0]);
+    EXPECT_EQ(childB, candidateB.getChildren()[1]);
+}
+
+TEST(ParsedElementTest, SharePrefixOfCandidate) {
+    ParsedElement original;
+    auto child1 = std::make_shared<ParsedElement>();
+    auto child2 = std::make_shared<ParsedElement>();
+    auto child3 = std::make_shared<ParsedElement>();
+    original.addChild(child1);
+
+    ParsedElement candidate;
+    candidate.shareChildren(original);
+    candidate.addChild(child2);
+    candidate.addChild(child3);
+
+    // a candidate of a candidate:
+    ParsedElement nestedCandidate;
+    nestedCandidate.shareChildren(candidate, 2);
+    std::vector<std::shared_ptr<ParsedElement>> children;
+    for(auto child : nestedCandidate.getChildren())
+    {
+        children.push_back(child);
+    }
+    ASSERT_EQ(2, children.size());
+    EXPECT_EQ(child1, children[0]);
+    EXPECT_EQ(child2, children[1]);
+
+    // the candidate is not changed by sharing:
+    ASSERT_EQ(3, candidate.getChildren().size());
+    EXPECT_EQ(child3, candidate.getChildren().back());
+    ASSERT_EQ(1, original.getChildren().size());
+}
+
+TEST(ParsedElementTest, CopyDoesNotSeeChildrenAddedLater) {
+    ParsedElement original;
+    original.addChild(std::make_shared<ParsedElement>());
+    ParsedElement copy(original);
+    original.addChild(std::make_shared<ParsedElement>());
+    copy.addChild(std::make_shared<ParsedElement>());
+    copy.addChild(std::make_shared<ParsedElement>());
+
+    EXPECT_EQ(2, original.getChildren().size());
+    EXPECT_EQ(3, copy.getChildren().size());
+    EXPECT_EQ(original.getChildren()[0], copy.getChildren()[0]);
+    EXPECT_NE(original.getChildren()[1], copy.getChildren()[1]);
+}
+
+TEST(ParsedElementTest, ConcatenationCandidatesShareParsedPrefix) {
+    Grammar grammar;
+    auto concatenation = grammar.createElement<Concatenation>();
+    auto alternation = grammar.createElement<Alternation>();
+    alternation->addChild(grammar.createElement<FixedString>("x"));
+    alternation->addChild(grammar.createElement<FixedString>("y"));
+    concatenation->addChild(grammar.createElement<FixedString>("a"));
+    concatenation->addChild(grammar.createElement<FixedString>("b"));
+    concatenation->addChild(alternation);
+
+    ParsedElement parent;
+    ParsedElement parsedElement(&parent);
+    ParseRc rc = concatenation->parse("ab", parsedElement);
+
+    ASSERT_EQ(2, rc.candidates.size());
+    EXPECT_EQ("abx", rc.candidates[0]->getMatchedString());
+    EXPECT_EQ("aby", rc.candidates[1]->getMatchedString());
+    for(auto candidate : rc.candidates)
+    {
+        ASSERT_EQ(3, candidate->getChildren().size());
+        EXPECT_EQ(parsedElement.getChildren()[0], candidate->getChildren()[0]);
+        EXPECT_EQ(parsedElement.getChildren()[1], candidate->getChildren()[1]);
+    }
+}
@@ -52,10 +52,20 @@ Status CliCall::Call(std::shared_ptr<grpc::Channel> channel,
   return call.Finish(server_trailing_metadata);
 }
 
+// MODIFIED (gWhisper): deadline and corked initial metadata
+// original: CliCall::CliCall(const std::shared_ptr<grpc::Channel>& channel,
+//                            const grpc::string& method,
+//                            const OutgoingMetadataContainer& metadata)
 CliCall::CliCall(const std::shared_ptr<grpc::Channel>& channel,
                  const grpc::string& method,
-                 const OutgoingMetadataContainer& metadata)
-    : stub_(new grpc::GenericStub(channel)) {
+                 const OutgoingMetadataContainer& metadata,
+                 const std::chrono::system_clock::time_point& deadline,
+                 bool cork_initial_metadata)
+// END MODIFIED
+    // MODIFIED (gWhisper): pipelined writes
+    // original: : stub_(new grpc::GenericStub(channel)) {
+    : stub_(new grpc::GenericStub(channel)), write_pending_(false) {
+  // END MODIFIED
   gpr_mu_init(&write_mu_);
   gpr_cv_init(&write_cv_);
   if (!metadata.empty()) {
@@ -64,8 +74,18 @@ CliCall::CliCall(const std::shared_ptr<grpc::Channel>& channel,
       ctx_.AddMetadata(iter->first, iter->second);
     }
   }
+  // MODIFIED (gWhisper): deadline and corked initial metadata
+  ctx_.set_deadline(deadline);
+  ctx_.set_initial_metadata_corked(cork_initial_metadata);
+  // END MODIFIED
   call_ = stub_->PrepareCall(&ctx_, method, &cq_);
   call_->StartCall(tag(1));
+  // MODIFIED (gWhisper): corked initial metadata
+  // corked: nothing is sent yet, the start does not complete on its own
+  if (cork_initial_metadata) {
+    return;
+  }
+  // END MODIFIED
   void* got_tag;
   bool ok;
   cq_.Next(&got_tag, &ok);
@@ -77,7 +97,10 @@ CliCall::~CliCall() {
   gpr_mu_destroy(&write_mu_);
 }
 
-void CliCall::Write(const grpc::string& request) {
+// MODIFIED (gWhisper): report ended calls instead of asserting
+// original: void CliCall::Write(const grpc::string& request) {
+bool CliCall::Write(const grpc::string& request) {
+// END MODIFIED
   void* got_tag;
   bool ok;
 
@@ -86,20 +109,30 @@ void CliCall::Write(const grpc::string& request) {
   grpc::ByteBuffer send_buffer(&req_slice, 1);
   call_->Write(send_buffer, tag(2));
   cq_.Next(&got_tag, &ok);
-  GPR_ASSERT(ok);
+  // MODIFIED (gWhisper): report ended calls instead of asserting
+  // original: GPR_ASSERT(ok);
+  return ok;
+  // END MODIFIED
 }
 
 bool CliCall::Read(grpc::string* response,
                    IncomingMetadataContainer* server_initial_metadata) {
-  void* got_tag;
-  bool ok;
-
+  // MODIFIED (gWhisper): zero-copy Read
+  // original:
+  // void* got_tag;
+  // bool ok;
+  //
+  // grpc::ByteBuffer recv_buffer;
+  // call_->Read(&recv_buffer, tag(3));
+  //
+  // if (!cq_.Next(&got_tag, &ok) || !ok) {
+  //   return false;
+  // }
   grpc::ByteBuffer recv_buffer;
-  call_->Read(&recv_buffer, tag(3));
-
-  if (!cq_.Next(&got_tag, &ok) || !ok) {
+  if (!Read(&recv_buffer, nullptr)) {
     return false;
   }
+  // END MODIFIED
   std::vector<grpc::Slice> slices;
   GPR_ASSERT(recv_buffer.Dump(&slices).ok());
 
@@ -114,14 +147,77 @@ bool CliCall::Read(grpc::string* response,
   return true;
 }
 
-void CliCall::WritesDone() {
+// MODIFIED (gWhisper): zero-copy Read
+bool CliCall::Read(grpc::ByteBuffer* response,
+                   IncomingMetadataContainer* server_initial_metadata) {
+  void* got_tag;
+  bool ok;
+
+  FlushWrites();
+
+  call_->Read(response, tag(3));
+  if (!cq_.Next(&got_tag, &ok) || !ok) {
+    return false;
+  }
+  if (server_initial_metadata) {
+    *server_initial_metadata = ctx_.GetServerInitialMetadata();
+  }
+  return true;
+}
+// END MODIFIED
+
+// MODIFIED (gWhisper): report ended calls instead of asserting
+// original: void CliCall::WritesDone() {
+bool CliCall::WritesDone() {
+// END MODIFIED
   void* got_tag;
   bool ok;
 
+  // MODIFIED (gWhisper): pipelined writes
+  if (!FlushWrites()) {
+    return false;
+  }
+  // END MODIFIED
+
   call_->WritesDone(tag(4));
   cq_.Next(&got_tag, &ok);
-  GPR_ASSERT(ok);
+  // MODIFIED (gWhisper): report ended calls instead of asserting
+  // original: GPR_ASSERT(ok);
+  return ok;
+  // END MODIFIED
+}
+
+// MODIFIED (gWhisper): cancellation and pipelined writes
+void CliCall::TryCancel() { ctx_.TryCancel(); }
+
+bool CliCall::WritePipelined(const grpc::string& request, bool last) {
+  if (!FlushWrites()) {
+    return false;
+  }
+
+  gpr_slice s = gpr_slice_from_copied_buffer(request.data(), request.size());
+  grpc::Slice req_slice(s, grpc::Slice::STEAL_REF);
+  grpc::ByteBuffer send_buffer(&req_slice, 1);
+  if (last) {
+    call_->WriteLast(send_buffer, grpc::WriteOptions(), tag(2));
+  } else {
+    call_->Write(send_buffer, grpc::WriteOptions().set_buffer_hint(), tag(2));
+  }
+  write_pending_ = true;
+  return true;
+}
+
+bool CliCall::FlushWrites() {
+  if (!write_pending_) {
+    return true;
+  }
+  void* got_tag;
+  bool ok;
+  cq_.Next(&got_tag, &ok);
+  write_pending_ = false;
+  return ok;
 }
+// END MODIFIED
 
 void CliCall::WriteAndWait(const grpc::string& request) {
   grpc::Slice req_slice(request);
@@ -202,6 +298,9 @@ Status CliCall::Finish(IncomingMetadataContainer* server_trailing_metadata) {
   bool ok;
   grpc::Status status;
 
+  // MODIFIED (gWhisper): pipelined writes
+  FlushWrites();
+  // END MODIFIED
   call_->Finish(&status, tag(5));
   cq_.Next(&got_tag, &ok);
   GPR_ASSERT(ok);
@@ -19,11 +19,13 @@
 #ifndef GRPC_TEST_CPP_UTIL_CLI_CALL_H
 #define GRPC_TEST_CPP_UTIL_CLI_CALL_H
 
+#include <chrono>
 #include <map>
 
 #include <grpcpp/channel.h>
 #include <grpcpp/completion_queue.h>
 #include <grpcpp/generic/generic_stub.h>
+#include <grpcpp/support/byte_buffer.h>
 #include <grpcpp/support/status.h>
 #include <grpcpp/support/string_ref.h>
 
@@ -46,9 +48,22 @@ class CliCall final {
   typedef std::multimap<grpc::string_ref, grpc::string_ref>
       IncomingMetadataContainer;
 
+  // MODIFIED (gWhisper): deadline and corked initial metadata
+  // original: CliCall(const std::shared_ptr<grpc::Channel>& channel,
+  //                   const grpc::string& method,
+  //                   const OutgoingMetadataContainer& metadata);
+  // The call fails with DEADLINE_EXCEEDED if it is not finished at deadline.
+  // If cork_initial_metadata is true, the initial metadata is sent together
+  // with the first request message (or WritesDone) in a single flush and the
+  // constructor returns without waiting for the call to start. Read must not
+  // be called before the first Write or WritesDone then.
   CliCall(const std::shared_ptr<grpc::Channel>& channel,
           const grpc::string& method,
-          const OutgoingMetadataContainer& metadata);
+          const OutgoingMetadataContainer& metadata,
+          const std::chrono::system_clock::time_point& deadline =
+              std::chrono::system_clock::time_point::max(),
+          bool cork_initial_metadata = false);
+  // END MODIFIED
   ~CliCall();
 
   // Perform an unary generic RPC.
@@ -59,16 +74,49 @@ class CliCall final {
                      IncomingMetadataContainer* server_initial_metadata,
                      IncomingMetadataContainer* server_trailing_metadata);
 
+  // MODIFIED (gWhisper): report ended calls, cancellation and pipelined writes
+  // original: void Write(const grpc::string& request);
+  //           void WritesDone();
+  // Write and WritesDone return false instead of asserting if the call has
+  // already ended (e.g. deadline exceeded or cancelled).
+
   // Send a generic request message in a synchronous manner. NOT thread-safe.
-  void Write(const grpc::string& request);
+  bool Write(const grpc::string& request);
 
   // Send a generic request message in a synchronous manner. NOT thread-safe.
-  void WritesDone();
+  bool WritesDone();
+
+  // Cancels the call if it is still in progress. Thread-safe, may be called
+  // while another thread is blocked in one of the other methods.
+  void TryCancel();
+
+  // Pipelined write. Starts sending a generic request message and returns
+  // without waiting for the write to complete, so the next message can be
+  // prepared while this one is in flight. Waits for the previous write first,
+  // as gRPC allows only one outstanding write per stream. Small messages are
+  // coalesced into fewer HTTP/2 frames (buffer hint). If last is true, the
+  // request stream is closed together with this write (WriteLast), so
+  // WritesDone must not be called. Returns false if the call already ended.
+  // NOT thread-safe.
+  bool WritePipelined(const grpc::string& request, bool last);
+
+  // Waits for the outstanding pipelined write to complete. Returns false if
+  // it failed. NOT thread-safe.
+  bool FlushWrites();
+  // END MODIFIED
 
   // Receive a generic response message in a synchronous manner.NOT thread-safe.
   bool Read(grpc::string* response,
             IncomingMetadataContainer* server_initial_metadata);
 
+  // MODIFIED (gWhisper): zero-copy Read
+  // Receive a generic response message in a synchronous manner without
+  // copying it: the buffer references the received slices, which may be
+  // parsed via grpc::ProtoBufferReader. NOT thread-safe.
+  bool Read(grpc::ByteBuffer* response,
+            IncomingMetadataContainer* server_initial_metadata);
+  // END MODIFIED
+
   // Thread-safe write. Must be used with ReadAndMaybeNotifyWrite. Send out a
   // generic request message and wait for ReadAndMaybeNotifyWrite to finish it.
   void WriteAndWait(const grpc::string& request);
@@ -98,6 +146,9 @@ class CliCall final {
   gpr_mu write_mu_;
   gpr_cv write_cv_;  // Protected by write_mu_;
   bool write_done_;  // Portected by write_mu_;
+  // MODIFIED (gWhisper): pipelined writes
+  bool write_pending_;  // a pipelined write was started but not completed
+  // END MODIFIED
 };
 
 }  // namespace testing